@@ -116,7 +116,7 @@ jml_cli_completion(const char *text,
 static void
 jml_cli_repl(void)
 {
-    printf(
+    jml_output_printf(
         "interactive jml -- v%s (on %s)\n",
         JML_VERSION_STRING,
         JML_PLATFORM_STRING
@@ -134,7 +134,8 @@ jml_cli_repl(void)
 #else
     char line[2048];
     while (true) {
-        printf("~> ");
+        jml_output_write("~> ", 3);
+        jml_output_flush();
 
         if (fgets(line, sizeof(line), stdin) == NULL)
             break;
@@ -148,13 +149,14 @@ jml_cli_repl(void)
         jml_value_t result = jml_vm_eval(vm, line);
 
         if (!IS_NONE(result)) {
-            printf("   ");
+            jml_output_write("   ", 3);
             jml_value_print(result);
-            printf("\n");
+            jml_output_write("\n", 1);
         }
 #else
         jml_vm_interpret(vm, line);
 #endif
+        jml_output_flush();
 
 #ifdef JML_CLI_READLINE
         free(line);
@@ -182,7 +184,7 @@ main(int argc, const char **argv)
     switch (argc) {
         case 1:
             jml_cli_repl();
-            printf("\n");
+            jml_output_write("\n", 1);
             success = true;
             break;
 
@@ -114,12 +114,37 @@
 
 #define MODULE_TABLE_HEAD           JML_APIM jml_module_function
 #define MODULE_FUNC_HEAD            JML_APIF void
+#define MODULE_SIGN_HEAD            JML_APIM jml_module_signature
+
+
+/*parameter types of a typed cfunction*/
+#define JML_PARAM_ANY               0x0000
+#define JML_PARAM_NUM               0x0001
+#define JML_PARAM_BOOL              0x0002
+#define JML_PARAM_NONE              0x0004
+#define JML_PARAM_STRING            0x0008
+#define JML_PARAM_ARRAY             0x0010
+#define JML_PARAM_BUFFER            0x0020
+#define JML_PARAM_MAP               0x0040
+#define JML_PARAM_CLASS             0x0080
+#define JML_PARAM_INSTANCE          0x0100
+#define JML_PARAM_FN                0x0200
+#define JML_PARAM_COROUTINE         0x0400
+
+#define JML_PARAM_MAX               4
+
+
+/*arity and parameters are checked by the vm*/
+#define JML_CFUNC_TYPED             0x01
+/*the result is never an exception*/
+#define JML_CFUNC_NOEXC             0x02
 
 
 /*API*/
 typedef struct jml_obj              jml_obj_t;
 typedef struct jml_obj_string       jml_obj_string_t;
 typedef struct jml_obj_array        jml_obj_array_t;
+typedef struct jml_obj_buffer       jml_obj_buffer_t;
 typedef struct jml_obj_map          jml_obj_map_t;
 typedef struct jml_obj_module       jml_obj_module_t;
 typedef struct jml_obj_class        jml_obj_class_t;
@@ -148,6 +173,15 @@ typedef struct {
 } jml_module_function;
 
 
+/*typed entries of module_table, exported as module_signatures*/
+typedef struct {
+    const char                     *name;
+    uint8_t                         flags;
+    uint8_t                         arity;
+    uint16_t                        params[JML_PARAM_MAX];
+} jml_module_signature;
+
+
 bool jml_module_add_value(jml_obj_module_t *module,
     const char *name, jml_value_t value);
 
@@ -155,6 +189,11 @@ bool jml_module_add_class(jml_obj_module_t *module,
     const char *name, jml_module_function *table, bool inheritable);
 
 
+/*
+ *type names and values are kept by reference until the message is read,
+ *so they must stay valid for the life of the process (string literals do);
+ *the raising module is kept loaded while its exceptions are reachable
+ */
 jml_obj_exception_t *jml_error_args(int arg_count, int expected_arg);
 
 jml_obj_exception_t *jml_error_implemented(jml_value_t value);
@@ -163,6 +202,9 @@ jml_obj_exception_t *jml_error_types(bool mult, int arg_count, ...);
 
 jml_obj_exception_t *jml_error_value(const char *value);
 
+jml_obj_exception_t *jml_error_params(const uint16_t *params,
+    int arity, int index);
+
 
 typedef enum {
     INTERPRET_OK,
@@ -199,6 +241,24 @@ void *jml_alloc(size_t size);
 void jml_free(void *ptr);
 
 
+typedef enum {
+    OUTPUT_LINE,
+    OUTPUT_BLOCK,
+    OUTPUT_EXPLICIT
+} jml_output_mode;
+
+
+void jml_output_write(const char *chars, size_t length);
+
+JML_FORMAT(1, 2) void jml_output_printf(const char *format, ...);
+
+void jml_output_flush(void);
+
+jml_output_mode jml_output_get_mode(void);
+
+void jml_output_set_mode(jml_output_mode mode);
+
+
 void jml_gc_exempt_push(jml_value_t value);
 
 jml_value_t jml_gc_exempt_pop(void);
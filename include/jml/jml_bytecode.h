@@ -7,6 +7,10 @@
 
 #define EXTENDED_OP(op)             op ## _EXTENDED
 
+/*closure capture operand flags*/
+#define CAPTURE_LOCAL               0x01
+#define CAPTURE_COPY                0x02
+
 
 typedef enum {
     OP_NOP,
@@ -41,10 +45,13 @@ typedef enum {
     OP_LOOP,
     OP_CALL,
     OP_TRY_CALL,
+    OP_TAIL_CALL,
     OP_INVOKE,
     EXTENDED_OP(OP_INVOKE),
     OP_TRY_INVOKE,
     EXTENDED_OP(OP_TRY_INVOKE),
+    OP_TAIL_INVOKE,
+    EXTENDED_OP(OP_TAIL_INVOKE),
     OP_TRY_SUPER_INVOKE,
     EXTENDED_OP(OP_TRY_SUPER_INVOKE),
     OP_SUPER_INVOKE,
@@ -81,6 +88,9 @@ typedef enum {
     EXTENDED_OP(OP_GET_MEMBER),
     OP_SET_INDEX,
     OP_GET_INDEX,
+    OP_ITER_INIT,
+    OP_ITER_NEXT,
+    OP_ITER_CHECK,
     OP_SWAP_GLOBAL,
     EXTENDED_OP(OP_SWAP_GLOBAL),
     OP_SWAP_LOCAL,
@@ -98,12 +108,28 @@ typedef enum {
 } jml_bytecode_op;
 
 
+/*the call itself evaluates to the exception*/
+#define HANDLER_CALL                UINT32_MAX
+
+
+/*protected range (start, end], only read while unwinding*/
+typedef struct {
+    uint32_t                        start;
+    uint32_t                        end;
+    uint32_t                        target;
+    uint32_t                        depth;
+} jml_handler_t;
+
+
 typedef struct {
     uint32_t                        count;
     uint32_t                        capacity;
     uint8_t                        *code;
     uint16_t                       *lines;
     jml_value_array_t               constants;
+    jml_handler_t                  *handlers;
+    uint32_t                        handler_count;
+    uint32_t                        handler_capacity;
 } jml_bytecode_t;
 
 
@@ -117,6 +143,12 @@ void jml_bytecode_free(jml_bytecode_t *bytecode);
 int jml_bytecode_add_const(jml_bytecode_t *bytecode,
     jml_value_t value);
 
+void jml_bytecode_add_handler(jml_bytecode_t *bytecode,
+    uint32_t start, uint32_t end, uint32_t target, uint32_t depth);
+
+jml_handler_t *jml_bytecode_find_handler(jml_bytecode_t *bytecode,
+    uint32_t offset);
+
 
 void jml_bytecode_disassemble(jml_bytecode_t *bytecode,
     const char *name);
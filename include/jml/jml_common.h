@@ -7,17 +7,23 @@
 
 
 #define LOCAL_MAX                   (UINT8_MAX + 1)
-#define FRAMES_MAX                  128
+#define FRAMES_MAX                  10000
 #define FRAMES_MIN                  8
-#define STACK_MAX                   (FRAMES_MAX * LOCAL_MAX)
 #define STACK_MIN                   128
-#define MAP_LOAD_MAX                0.75
-#define EXEMPT_MAX                  16
+#define STACK_SEGMENT               4096
+#define STACK_RESERVE               32
+#define MAP_LOAD_MAX                0.875
+#define STRINGS_SHARD_BITS          6
+#define STRINGS_SHARDS              (1 << STRINGS_SHARD_BITS)
+#define STRINGS_SHARD(hash)         ((hash) >> (32 - STRINGS_SHARD_BITS))
+#define CALLBACK_MAX                256
+#define FORMAT_CACHE                256
+#define OUTPUT_MAX                  8192
 #define SERIAL_MIN                  512
 
 
 #define JML_BACKTRACE
-#undef  JML_LAZY_IMPORT
+#define JML_LAZY_IMPORT
 #define JML_EVAL
 
 
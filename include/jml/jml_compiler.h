@@ -64,9 +64,18 @@ typedef struct {
     jml_token_t                     name;
     int                             depth;
     bool                            captured;
+    bool                            assigned;
 } jml_local_t;
 
 
+/*closure operand waiting for its local to go out of scope*/
+typedef struct {
+    jml_obj_function_t             *function;
+    uint32_t                        offset;
+    int                             local;
+} jml_capture_t;
+
+
 typedef struct jml_loop {
     struct jml_loop                *enclosing;
     int                             start;
@@ -89,10 +98,14 @@ struct jml_compiler {
     jml_local_t                     locals[LOCAL_MAX];
     int                             local_count;
     jml_upvalue_t                   upvalues[LOCAL_MAX];
+    jml_capture_t                   captures[LOCAL_MAX];
+    int                             capture_count;
     int                             scope_depth;
     jml_obj_module_t               *module;
     int                             module_const;
     jml_loop_t                     *loop;
+    int                             last_call;
+    int                             handler_depth;
     bool                            output;
     jml_parser_t                   *parser;
     jml_class_compiler_t           *klass;
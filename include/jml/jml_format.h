@@ -0,0 +1,37 @@
+#ifndef JML_FORMAT_H_
+#define JML_FORMAT_H_
+
+#include <jml.h>
+
+#include <jml/jml_util.h>
+
+
+/*a literal run, followed by a replacement field unless it is the last*/
+typedef struct {
+    uint32_t                        offset;
+    uint32_t                        length;
+    bool                            field;
+    char                            fill;
+    char                            align;
+    int32_t                         width;
+    int32_t                         precision;
+} jml_format_segment_t;
+
+
+typedef struct jml_format {
+    uint32_t                        count;
+    uint32_t                        fields;
+    jml_format_segment_t            segments[];
+} jml_format_t;
+
+
+jml_value_t jml_format(jml_obj_string_t *format,
+    int arg_count, jml_value_t *args);
+
+bool jml_format_write(jml_strbuf_t *buf, jml_obj_string_t *format,
+    int arg_count, jml_value_t *args, jml_obj_exception_t **exc);
+
+void jml_format_release(jml_obj_string_t *string);
+
+
+#endif /* JML_FORMAT_H_ */
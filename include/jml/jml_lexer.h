@@ -77,6 +77,7 @@ typedef enum {
     TOKEN_ASYNC,
     TOKEN_AWAIT,
     TOKEN_TRY,
+    TOKEN_CATCH,
     TOKEN_SPREAD,
     TOKEN_AND,
     TOKEN_NOT,
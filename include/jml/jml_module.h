@@ -15,6 +15,12 @@ bool jml_module_close(jml_obj_module_t *module);
 jml_obj_cfunction_t *jml_module_get_raw(jml_obj_module_t *module,
     const char *name, bool silent);
 
+/*lazy import binds module_table entries on first use*/
+jml_obj_cfunction_t *jml_module_lazy_bind(jml_obj_module_t *module,
+    jml_obj_string_t *name);
+
+void jml_module_lazy_bind_all(jml_obj_module_t *module);
+
 void jml_module_register(jml_obj_module_t *module,
     jml_module_function *table);
 
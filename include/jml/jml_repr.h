@@ -3,9 +3,13 @@
 
 #include <jml.h>
 
+#include <jml/jml_util.h>
+
 
 void jml_value_print(jml_value_t value);
 
+void jml_value_write(jml_strbuf_t *buf, jml_value_t value);
+
 char *jml_value_stringify(jml_value_t value);
 
 const char *jml_value_stringify_type(jml_value_t value);
@@ -13,6 +17,8 @@ const char *jml_value_stringify_type(jml_value_t value);
 
 void jml_obj_print(jml_value_t value);
 
+void jml_obj_write(jml_strbuf_t *buf, jml_value_t value);
+
 char *jml_obj_stringify(jml_value_t value);
 
 const char *jml_obj_stringify_type(jml_value_t value);
@@ -1,6 +1,8 @@
 #ifndef JML_TYPE_H_
 #define JML_TYPE_H_
 
+#include <string.h>
+
 #include <jml.h>
 
 #include <jml/jml_value.h>
@@ -12,6 +14,7 @@
 
 #define IS_STRING(value)            jml_obj_has_type(value, OBJ_STRING)
 #define IS_ARRAY(value)             jml_obj_has_type(value, OBJ_ARRAY)
+#define IS_BUFFER(value)            jml_obj_has_type(value, OBJ_BUFFER)
 #define IS_MAP(value)               jml_obj_has_type(value, OBJ_MAP)
 #define IS_MODULE(value)            jml_obj_has_type(value, OBJ_MODULE)
 #define IS_CLASS(value)             jml_obj_has_type(value, OBJ_CLASS)
@@ -27,6 +30,7 @@
 #define AS_STRING(value)            ((jml_obj_string_t*)AS_OBJ(value))
 #define AS_CSTRING(value)           (((jml_obj_string_t*)AS_OBJ(value))->chars)
 #define AS_ARRAY(value)             ((jml_obj_array_t*)AS_OBJ(value))
+#define AS_BUFFER(value)            ((jml_obj_buffer_t*)AS_OBJ(value))
 #define AS_MAP(value)               ((jml_obj_map_t*)AS_OBJ(value))
 #define AS_MODULE(value)            ((jml_obj_module_t*)AS_OBJ(value))
 #define AS_CLASS(value)             ((jml_obj_class_t*)AS_OBJ(value))
@@ -42,6 +46,7 @@
 typedef enum {
     OBJ_STRING,
     OBJ_ARRAY,
+    OBJ_BUFFER,
     OBJ_MAP,
     OBJ_MODULE,
     OBJ_CLASS,
@@ -68,6 +73,7 @@ struct jml_obj_string {
     char                           *chars;
     size_t                          length;
     uint32_t                        hash;
+    uint32_t                        format;
 };
 
 
@@ -77,6 +83,31 @@ struct jml_obj_array {
 };
 
 
+typedef void (*jml_release)(uint8_t *bytes, size_t length);
+
+
+/*element type, lengths and offsets stay in bytes*/
+typedef enum {
+    BUFFER_U8,
+    BUFFER_I32,
+    BUFFER_F64
+} jml_buffer_type;
+
+
+/*views share the bytes of their owner*/
+struct jml_obj_buffer {
+    jml_obj_t                       obj;
+    uint8_t                        *bytes;
+    size_t                          length;
+    size_t                          capacity;
+    size_t                          offset;
+    bool                            readonly;
+    jml_buffer_type                 type;
+    struct jml_obj_buffer          *owner;
+    jml_release                     release;
+};
+
+
 struct jml_obj_map {
     jml_obj_t                       obj;
     jml_hashmap_t                   hashmap;
@@ -105,6 +136,7 @@ struct jml_obj_instance {
     jml_obj_t                       obj;
     jml_obj_class_t                *klass;
     jml_hashmap_t                   fields;
+    jml_hashmap_t                   methods;
     void                           *extra;
 };
 
@@ -125,6 +157,7 @@ struct jml_obj_function {
     jml_obj_string_t               *name;
     jml_obj_string_t               *klass_name;
     jml_obj_module_t               *module;
+    struct jml_obj_closure         *closure;
 };
 
 
@@ -133,6 +166,9 @@ struct jml_obj_closure {
     jml_obj_function_t             *function;
     jml_obj_upvalue_t             **upvalues;
     uint16_t                        upvalue_count;
+    /*immutable captures copied by value, not heap objects*/
+    jml_obj_upvalue_t              *copies;
+    uint16_t                        copy_count;
 };
 
 
@@ -144,6 +180,17 @@ struct jml_obj_upvalue {
 };
 
 
+/*segments never move, values only get copied to a newer one*/
+typedef struct jml_stack_segment {
+    struct jml_stack_segment       *prev;
+    struct jml_stack_segment       *next;
+    jml_value_t                    *top;
+    uint32_t                        capacity;
+    jml_value_t                     values[];
+} jml_stack_segment_t;
+
+
+/*stack and stack_capacity mirror the current segment*/
 struct jml_obj_coroutine {
     jml_obj_t                       obj;
     jml_call_frame_t               *frames;
@@ -153,6 +200,7 @@ struct jml_obj_coroutine {
     jml_value_t                    *stack;
     jml_value_t                    *stack_top;
     uint32_t                        stack_capacity;
+    jml_stack_segment_t            *segment;
     struct jml_obj_coroutine       *caller;
 };
 
@@ -168,14 +216,23 @@ struct jml_obj_cfunction {
     jml_cfunction                   function;
     jml_obj_string_t               *klass_name;
     jml_obj_module_t               *module;
+    uint8_t                         flags;
+    uint8_t                         arity;
+    uint16_t                        params[JML_PARAM_MAX];
 };
 
 
+/*builds the message of a lazy exception*/
+typedef jml_obj_string_t *(*jml_exception_render)(jml_obj_exception_t *exc);
+
+
 struct jml_obj_exception {
     jml_obj_t                       obj;
     jml_obj_string_t               *name;
     jml_obj_string_t               *message;
     jml_obj_module_t               *module;
+    jml_exception_render            render;
+    uintptr_t                       detail[4];
 };
 
 
@@ -191,6 +248,19 @@ void jml_obj_array_append(jml_obj_array_t *array, jml_value_t value);
 
 void jml_obj_array_add(jml_obj_array_t *source, jml_obj_array_t *dest);
 
+jml_obj_buffer_t *jml_obj_buffer_new(size_t length);
+
+jml_obj_buffer_t *jml_obj_buffer_copy(const uint8_t *bytes,
+    size_t length);
+
+jml_obj_buffer_t *jml_obj_buffer_wrap(uint8_t *bytes,
+    size_t length, jml_release release);
+
+jml_obj_buffer_t *jml_obj_buffer_view(jml_obj_buffer_t *buffer,
+    size_t offset, size_t length);
+
+bool jml_obj_buffer_resize(jml_obj_buffer_t *buffer, size_t length);
+
 jml_obj_map_t *jml_obj_map_new(void);
 
 jml_obj_module_t *jml_obj_module_new(jml_obj_string_t *name, void *handle);
@@ -206,21 +276,50 @@ jml_obj_function_t *jml_obj_function_new(void);
 
 jml_obj_closure_t *jml_obj_closure_new(jml_obj_function_t *function);
 
+jml_obj_closure_t *jml_obj_closure_flat(jml_obj_function_t *function,
+    uint16_t copy_count);
+
 jml_obj_upvalue_t *jml_obj_upvalue_new(jml_value_t *slot);
 
 jml_obj_coroutine_t *jml_obj_coroutine_new(jml_obj_closure_t *closure);
 
 void jml_obj_coroutine_grow(jml_obj_coroutine_t *coroutine);
 
+jml_value_t *jml_obj_coroutine_split(jml_obj_coroutine_t *coroutine,
+    uint32_t count);
+
+void jml_obj_coroutine_seek(jml_obj_coroutine_t *coroutine,
+    jml_value_t *top);
+
+void jml_obj_coroutine_reset(jml_obj_coroutine_t *coroutine);
+
+void jml_obj_coroutine_free(jml_obj_coroutine_t *coroutine);
+
 jml_obj_cfunction_t *jml_obj_cfunction_new(jml_obj_string_t *name,
     jml_cfunction function, jml_obj_module_t *module);
 
+jml_obj_exception_t *jml_obj_cfunction_check(jml_obj_cfunction_t *cfunction,
+    int arg_count, jml_value_t *args);
+
 jml_obj_exception_t *jml_obj_exception_new(const char *name,
     const char *message);
 
 jml_obj_exception_t *jml_obj_exception_format(const char *name,
     char *format, ...);
 
+jml_obj_exception_t *jml_obj_exception_lazy(const char *name,
+    jml_exception_render render);
+
+jml_obj_string_t *jml_obj_exception_message(jml_obj_exception_t *exc);
+
+
+static inline bool
+jml_stack_segment_owns(jml_stack_segment_t *segment, jml_value_t *value)
+{
+    return value >= segment->values
+        && value < segment->values + segment->capacity;
+}
+
 
 static inline bool
 jml_obj_has_type(jml_value_t value, jml_obj_type type)
@@ -230,4 +329,140 @@ jml_obj_has_type(jml_value_t value, jml_obj_type type)
 }
 
 
+static inline uint8_t *
+jml_obj_buffer_data(jml_obj_buffer_t *buffer)
+{
+    if (buffer->owner != NULL)
+        return buffer->owner->bytes + buffer->offset;
+
+    return buffer->bytes;
+}
+
+
+static inline size_t
+jml_obj_buffer_stride(jml_buffer_type type)
+{
+    switch (type) {
+        case BUFFER_I32:    return sizeof(int32_t);
+        case BUFFER_F64:    return sizeof(double);
+        default:            return sizeof(uint8_t);
+    }
+}
+
+
+static inline size_t
+jml_obj_buffer_count(jml_obj_buffer_t *buffer)
+{
+    return buffer->length / jml_obj_buffer_stride(buffer->type);
+}
+
+
+/*elements are copied, as views may be unaligned*/
+static inline double
+jml_obj_buffer_load(jml_obj_buffer_t *buffer, size_t index)
+{
+    uint8_t *data = jml_obj_buffer_data(buffer);
+
+    switch (buffer->type) {
+        case BUFFER_I32: {
+            int32_t element;
+            memcpy(&element, data + index * sizeof(int32_t), sizeof(int32_t));
+            return element;
+        }
+
+        case BUFFER_F64: {
+            double element;
+            memcpy(&element, data + index * sizeof(double), sizeof(double));
+            return element;
+        }
+
+        default:
+            return data[index];
+    }
+}
+
+
+/*integers wrap, nan and out of range values become zero*/
+static inline int64_t
+jml_obj_number_wrap(double number)
+{
+    return number > -9.2e18 && number < 9.2e18
+        ? (int64_t)number : 0;
+}
+
+
+/*lengths are capped at 4 GiB, nan is rejected*/
+static inline bool
+jml_obj_buffer_size(double number, size_t *length)
+{
+    if (!(number >= 0 && number <= UINT32_MAX))
+        return false;
+
+    *length = (size_t)number;
+    return true;
+}
+
+
+static inline void
+jml_obj_buffer_store(jml_obj_buffer_t *buffer, size_t index, double number)
+{
+    uint8_t *data = jml_obj_buffer_data(buffer);
+    int64_t integer = jml_obj_number_wrap(number);
+
+    switch (buffer->type) {
+        case BUFFER_I32: {
+            int32_t element = (int32_t)(uint32_t)integer;
+            memcpy(data + index * sizeof(int32_t), &element, sizeof(int32_t));
+            break;
+        }
+
+        case BUFFER_F64:
+            memcpy(data + index * sizeof(double), &number, sizeof(double));
+            break;
+
+        default:
+            data[index] = (uint8_t)integer;
+            break;
+    }
+}
+
+
+/*bytes of either a string or a buffer*/
+static inline bool
+jml_obj_bytes(jml_value_t value, const uint8_t **bytes, size_t *length)
+{
+    if (IS_STRING(value)) {
+        *bytes  = (const uint8_t*)AS_STRING(value)->chars;
+        *length = AS_STRING(value)->length;
+        return true;
+    }
+
+    if (IS_BUFFER(value)) {
+        *bytes  = jml_obj_buffer_data(AS_BUFFER(value));
+        *length = AS_BUFFER(value)->length;
+        return true;
+    }
+
+    return false;
+}
+
+
+
+/*calls a cfunction from c, running its declared checks*/
+static inline jml_value_t
+jml_obj_cfunction_call(jml_obj_cfunction_t *cfunction,
+    int arg_count, jml_value_t *args)
+{
+    if (cfunction->flags & JML_CFUNC_TYPED) {
+        jml_obj_exception_t *exc = jml_obj_cfunction_check(
+            cfunction, arg_count, args);
+
+        if (exc != NULL)
+            return OBJ_VAL(exc);
+    }
+
+    return cfunction->function(arg_count, args);
+}
+
+
 #endif /* JML_TYPE_H_ */
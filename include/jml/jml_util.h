@@ -1,6 +1,8 @@
 #ifndef JML_UTIL_H_
 #define JML_UTIL_H_
 
+#include <stdarg.h>
+
 #include <jml/jml_common.h>
 
 
@@ -13,6 +15,29 @@ char *jml_strdup(const char *str);
 char *jml_strcat(char *dest, char *src);
 
 
+/*growable character buffer, always null terminated*/
+typedef struct {
+    char                           *chars;
+    size_t                          length;
+    size_t                          capacity;
+} jml_strbuf_t;
+
+
+void jml_strbuf_init(jml_strbuf_t *buf, size_t capacity);
+
+void jml_strbuf_reserve(jml_strbuf_t *buf, size_t extra);
+
+void jml_strbuf_append(jml_strbuf_t *buf, const char *chars, size_t length);
+
+void jml_strbuf_fill(jml_strbuf_t *buf, char c, size_t count);
+
+void jml_strbuf_vprintf(jml_strbuf_t *buf, const char *format, va_list args);
+
+void jml_strbuf_printf(jml_strbuf_t *buf, const char *format, ...);
+
+void jml_strbuf_free(jml_strbuf_t *buf);
+
+
 static inline bool
 jml_strprfx(const char *str,
     const char *pre, size_t length)
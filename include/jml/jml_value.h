@@ -97,10 +97,12 @@ typedef struct {
 #endif
 
 
+/*base is where the result goes, slots may sit in a newer segment*/
 typedef struct {
     jml_obj_closure_t              *closure;
     uint8_t                        *pc;
     jml_value_t                    *slots;
+    jml_value_t                    *base;
 } jml_call_frame_t;
 
 
@@ -116,6 +118,12 @@ void jml_value_array_init(jml_value_array_t *array);
 void jml_value_array_write(jml_value_array_t *array,
     jml_value_t value);
 
+void jml_value_array_reserve(jml_value_array_t *array,
+    int capacity);
+
+void jml_value_array_extend(jml_value_array_t *array,
+    const jml_value_t *values, int count);
+
 void jml_value_array_free(jml_value_array_t *array);
 
 
@@ -125,9 +133,12 @@ typedef struct {
 } jml_hashmap_entry_t;
 
 
+/*entries without a key are free slots*/
 typedef struct {
     int                             count;
+    int                             tombs;
     int                             capacity;
+    uint8_t                        *control;
     jml_hashmap_entry_t            *entries;
 } jml_hashmap_t;
 
@@ -152,7 +163,7 @@ void jml_hashmap_add(jml_hashmap_t *source, jml_hashmap_t *dest);
 jml_obj_string_t *jml_hashmap_find(jml_hashmap_t *map,
     const char *chars, size_t length, uint32_t hash);
 
-void jml_hashmap_remove_white(jml_hashmap_t *map);
+void jml_hashmap_shrink(jml_hashmap_t *map);
 
 void jml_hashmap_mark(jml_hashmap_t *map);
 
@@ -4,6 +4,7 @@
 #include <jml/jml_value.h>
 #include <jml/jml_type.h>
 #include <jml/jml_compiler.h>
+#include <jml/jml_util.h>
 
 
 #ifdef JML_VM_INTERNAL
@@ -12,8 +13,12 @@ struct jml_vm {
     jml_vm_context_t               *context;
 
     jml_obj_coroutine_t            *running;
+    uint32_t                        recursion_limit;
     jml_obj_module_t               *current;
     jml_obj_cfunction_t            *external;
+    jml_obj_coroutine_t            *callback;
+    jml_obj_exception_t            *raised;
+    uint32_t                        callback_depth;
 
     jml_obj_t                      *objects;
     size_t                          allocated;
@@ -25,13 +30,22 @@ struct jml_vm {
     jml_compiler_t                 *compilers[4];
     jml_compiler_t                 **compiler_top;
 
-    jml_value_t                     exempt_stack[EXEMPT_MAX];
-    jml_value_t                    *exempt_top;
+    int64_t                         exempt_count;
+    int64_t                         exempt_capacity;
+    jml_value_t                    *exempt_stack;
 
     jml_hashmap_t                   globals;
-    jml_hashmap_t                   strings;
+    jml_hashmap_t                   strings[STRINGS_SHARDS];
+    uint64_t                        strings_dirty;
     jml_hashmap_t                   modules;
     jml_hashmap_t                   builtins;
+    uint64_t                        hash_seed;
+
+    struct jml_format              *formats[FORMAT_CACHE];
+    uint32_t                        format_hint;
+
+    jml_strbuf_t                    output;
+    jml_output_mode                 output_mode;
 
     jml_obj_string_t               *main_string;
     jml_obj_string_t               *module_string;
@@ -53,6 +67,8 @@ struct jml_vm {
     jml_obj_string_t               *get_string;
     jml_obj_string_t               *set_string;
     jml_obj_string_t               *size_string;
+    jml_obj_string_t               *iter_string;
+    jml_obj_string_t               *next_string;
     jml_obj_string_t               *print_string;
     jml_obj_string_t               *str_string;
     jml_obj_string_t               *inherit_string;
@@ -65,12 +81,20 @@ void jml_vm_init(jml_vm_t *vm, jml_vm_context_t *context);
 
 void jml_vm_error(const char *format, ...);
 
+void jml_vm_report(jml_obj_exception_t *exc);
+
+void jml_output_commit(size_t start);
+
 bool jml_vm_call_value(jml_obj_coroutine_t *coroutine,
     jml_value_t callee, int arg_count);
 
 jml_interpret_result jml_vm_call_coroutine(
     jml_obj_coroutine_t *coroutine, jml_value_t *last);
 
+/*on failure the result is the exception raised, or none*/
+bool jml_vm_callback(jml_obj_coroutine_t *coroutine, jml_value_t callee,
+    int arg_count, jml_value_t *args, jml_value_t *result);
+
 void jml_cfunction_register(const char *name,
     jml_cfunction function, jml_obj_module_t *module);
 
@@ -15,6 +15,10 @@ jml_bytecode_init(jml_bytecode_t *bytecode)
     bytecode->lines         = NULL;
     bytecode->capacity      = 0;
 
+    bytecode->handlers          = NULL;
+    bytecode->handler_count     = 0;
+    bytecode->handler_capacity  = 0;
+
     jml_value_array_init(&bytecode->constants);
 }
 
@@ -46,6 +50,7 @@ jml_bytecode_free(jml_bytecode_t *bytecode)
 {
     FREE_ARRAY(uint8_t, bytecode->code, bytecode->capacity);
     FREE_ARRAY(uint16_t, bytecode->lines, bytecode->capacity);
+    FREE_ARRAY(jml_handler_t, bytecode->handlers, bytecode->handler_capacity);
 
     jml_value_array_free(&bytecode->constants);
     jml_bytecode_init(bytecode);
@@ -64,13 +69,49 @@ jml_bytecode_add_const(jml_bytecode_t *bytecode,
 }
 
 
+void
+jml_bytecode_add_handler(jml_bytecode_t *bytecode,
+    uint32_t start, uint32_t end, uint32_t target, uint32_t depth)
+{
+    if (bytecode->handler_capacity < bytecode->handler_count + 1) {
+        uint32_t old_capacity       = bytecode->handler_capacity;
+        bytecode->handler_capacity  = GROW_CAPACITY(old_capacity);
+
+        bytecode->handlers = GROW_ARRAY(jml_handler_t, bytecode->handlers,
+            old_capacity, bytecode->handler_capacity);
+    }
+
+    jml_handler_t *handler  = &bytecode->handlers[bytecode->handler_count++];
+    handler->start          = start;
+    handler->end            = end;
+    handler->target         = target;
+    handler->depth          = depth;
+}
+
+
+/*inner handlers are added before the ones enclosing them*/
+jml_handler_t *
+jml_bytecode_find_handler(jml_bytecode_t *bytecode,
+    uint32_t offset)
+{
+    for (uint32_t i = 0; i < bytecode->handler_count; ++i) {
+        jml_handler_t *handler = &bytecode->handlers[i];
+
+        if (offset > handler->start && offset <= handler->end)
+            return handler;
+    }
+
+    return NULL;
+}
+
+
 void
 jml_bytecode_disassemble(jml_bytecode_t *bytecode,
     const char *name)
 {
     uint16_t pad = (25 - strlen(name)) / 2;
 
-    printf(
+    jml_output_printf(
         "======   %*s%s%*s   ======\n"
         "OFFSET   LINE   OPCODE              DATA\n",
         pad, "", name, pad, ""
@@ -81,6 +122,27 @@ jml_bytecode_disassemble(jml_bytecode_t *bytecode,
             bytecode, offset
         );
     }
+
+    for (uint32_t i = 0; i < bytecode->handler_count; ++i) {
+        jml_handler_t *handler = &bytecode->handlers[i];
+
+        if (handler->target == HANDLER_CALL)
+            jml_output_printf("HANDLER  %04d -> %04d   call\n",
+                handler->start, handler->end);
+        else
+            jml_output_printf("HANDLER  %04d -> %04d   catch %04d (depth %d)\n",
+                handler->start, handler->end, handler->target, handler->depth);
+    }
+}
+
+
+static const char *
+jml_bytecode_capture_name(uint8_t capture)
+{
+    if (capture & CAPTURE_COPY)
+        return capture & CAPTURE_LOCAL ? "local copy" : "upvalue copy";
+
+    return capture & CAPTURE_LOCAL ? "local" : "upvalue";
 }
 
 
@@ -88,7 +150,7 @@ static uint32_t
 jml_bytecode_instruction_simple(const char *name,
     uint32_t offset)
 {
-    printf("%s\n", name);
+    jml_output_printf("%s\n", name);
 
     return offset + 1;
 }
@@ -98,7 +160,7 @@ static uint32_t
 jml_bytecode_instruction_byte(const char *name,
     jml_bytecode_t *bytecode, uint32_t offset)
 {
-    printf("%-16s %4d\n", name, bytecode->code[offset + 1]);
+    jml_output_printf("%-16s %4d\n", name, bytecode->code[offset + 1]);
     return offset + 2;
 }
 
@@ -107,7 +169,7 @@ static uint32_t
 jml_bytecode_instruction_bytes(const char *name,
     jml_bytecode_t *bytecode, uint32_t offset)
 {
-    printf(
+    jml_output_printf(
         "%-16s %4d %4d\n", name,
         bytecode->code[offset + 1],
         bytecode->code[offset + 2]
@@ -123,7 +185,7 @@ jml_bytecode_instruction_short(const char *name,
     uint16_t short1     = (uint16_t)(bytecode->code[offset + 1] << 8);
     short1              |= bytecode->code[offset + 2];
 
-    printf("%-16s %d\n", name, short1);
+    jml_output_printf("%-16s %d\n", name, short1);
     return offset + 3;
 }
 
@@ -135,7 +197,7 @@ jml_bytecode_instruction_jump(const char *name,
     uint16_t jump       = (uint16_t)(bytecode->code[offset + 1] << 8);
     jump                |= bytecode->code[offset + 2];
 
-    printf("%-16s %4d -> %d\n",
+    jml_output_printf("%-16s %4d -> %d\n",
         name, offset, offset + 3 + sign * jump
     );
 
@@ -143,6 +205,22 @@ jml_bytecode_instruction_jump(const char *name,
 }
 
 
+static uint32_t
+jml_bytecode_instruction_iter(const char *name,
+    jml_bytecode_t *bytecode, uint32_t offset)
+{
+    uint16_t jump       = (uint16_t)(bytecode->code[offset + 2] << 8);
+    jump                |= bytecode->code[offset + 3];
+
+    jml_output_printf("%-16s %4d %4d -> %d\n",
+        name, bytecode->code[offset + 1],
+        offset, offset + 4 + jump
+    );
+
+    return offset + 4;
+}
+
+
 static uint32_t
 jml_bytecode_instruction_invoke(const char *name,
     jml_bytecode_t *bytecode, uint32_t offset)
@@ -150,9 +228,9 @@ jml_bytecode_instruction_invoke(const char *name,
     uint8_t constant    = bytecode->code[offset + 1];
     uint8_t arg_count   = bytecode->code[offset + 2];
 
-    printf("%-16s (%d args) %4d '", name, arg_count, constant);
+    jml_output_printf("%-16s (%d args) %4d '", name, arg_count, constant);
     jml_value_print(bytecode->constants.values[constant]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 3;
 }
@@ -168,9 +246,9 @@ jml_bytecode_instruction_invoke_extended(const char *name,
     uint16_t arg_count  = (uint16_t)(bytecode->code[offset + 3] << 8);
     arg_count           |= bytecode->code[offset + 4];
 
-    printf("%-16s (%d args) %d '", name, arg_count, constant);
+    jml_output_printf("%-16s (%d args) %d '", name, arg_count, constant);
     jml_value_print(bytecode->constants.values[constant]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 5;
 }
@@ -181,9 +259,9 @@ jml_bytecode_instruction_const(const char *name,
     jml_bytecode_t *bytecode, uint32_t offset)
 {
     uint8_t constant    = bytecode->code[offset + 1];
-    printf("%-16s %4d '", name, constant);
+    jml_output_printf("%-16s %4d '", name, constant);
     jml_value_print(bytecode->constants.values[constant]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 2;
 }
@@ -196,9 +274,9 @@ jml_bytecode_instruction_const_extended(const char *name,
     uint16_t constant   = (uint16_t)(bytecode->code[offset + 1] << 8);
     constant            |= bytecode->code[offset + 2];
 
-    printf("%-16s %d '", name, constant);
+    jml_output_printf("%-16s %d '", name, constant);
     jml_value_print(bytecode->constants.values[constant]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 3;
 }
@@ -211,11 +289,11 @@ jml_bytecode_instruction_consts(const char *name,
     uint8_t byte1       = bytecode->code[offset + 1];
     uint8_t byte2       = bytecode->code[offset + 2];
 
-    printf("%-16s %4d '", name, byte1);
+    jml_output_printf("%-16s %4d '", name, byte1);
     jml_value_print(bytecode->constants.values[byte1]);
-    printf("'    %4d '", byte2);
+    jml_output_printf("'    %4d '", byte2);
     jml_value_print(bytecode->constants.values[byte2]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 3;
 }
@@ -231,11 +309,11 @@ jml_bytecode_instruction_consts_extended(const char *name,
     uint16_t short2     = (uint16_t)(bytecode->code[offset + 3] << 8);
     short2              |= bytecode->code[offset + 4];
 
-    printf("%-16s %4d '", name, short1);
+    jml_output_printf("%-16s %4d '", name, short1);
     jml_value_print(bytecode->constants.values[short1]);
-    printf("'    %4d '", short2);
+    jml_output_printf("'    %4d '", short2);
     jml_value_print(bytecode->constants.values[short2]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 5;
 }
@@ -249,13 +327,13 @@ jml_bytecode_instruction_triple(const char *name,
     uint8_t byte2       = bytecode->code[offset + 2];
     uint8_t byte3       = bytecode->code[offset + 3];
 
-    printf("%-16s %4d '", name, byte1);
+    jml_output_printf("%-16s %4d '", name, byte1);
     jml_value_print(bytecode->constants.values[byte1]);
-    printf("'    %4d '", byte2);
+    jml_output_printf("'    %4d '", byte2);
     jml_value_print(bytecode->constants.values[byte2]);
-    printf("'    %4d '", byte3);
+    jml_output_printf("'    %4d '", byte3);
     jml_value_print(bytecode->constants.values[byte3]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 4;
 }
@@ -274,13 +352,13 @@ jml_bytecode_instruction_triple_extended(const char *name,
     uint16_t short3     = (uint16_t)(bytecode->code[offset + 5] << 8);
     short3              |= bytecode->code[offset + 6];
 
-    printf("%-16s %4d '", name, short1);
+    jml_output_printf("%-16s %4d '", name, short1);
     jml_value_print(bytecode->constants.values[short1]);
-    printf("'    %4d '", short2);
+    jml_output_printf("'    %4d '", short2);
     jml_value_print(bytecode->constants.values[short2]);
-    printf("'    %4d '", short3);
+    jml_output_printf("'    %4d '", short3);
     jml_value_print(bytecode->constants.values[short3]);
-    printf("'\n");
+    jml_output_printf("'\n");
 
     return offset + 7;
 }
@@ -289,13 +367,13 @@ jml_bytecode_instruction_triple_extended(const char *name,
 uint32_t
 jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
 {
-    printf("%04d    ", offset);
+    jml_output_printf("%04d    ", offset);
     if (offset > 0 &&
         bytecode->lines[offset] == bytecode->lines[offset - 1]) {
 
-        printf("   |    ");
+        jml_output_printf("   |    ");
     } else {
-        printf("%4d    ", bytecode->lines[offset]);
+        jml_output_printf("%4d    ", bytecode->lines[offset]);
     }
 
     uint8_t instruction = bytecode->code[offset];
@@ -394,8 +472,11 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_CALL:
             return jml_bytecode_instruction_byte("OP_CALL", bytecode, offset);
 
+        case OP_TAIL_CALL:
+            return jml_bytecode_instruction_byte("OP_TAIL_CALL", bytecode, offset);
+
         case OP_TRY_CALL:
-            return jml_bytecode_instruction_bytes("OP_TRY_CALL", bytecode, offset);
+            return jml_bytecode_instruction_byte("OP_TRY_CALL", bytecode, offset);
 
         case OP_INVOKE:
             return jml_bytecode_instruction_invoke("OP_INVOKE", bytecode, offset);
@@ -404,10 +485,16 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
             return jml_bytecode_instruction_invoke_extended("OP_INVOKE_EXTENDED", bytecode, offset);
 
         case OP_TRY_INVOKE:
-            return jml_bytecode_instruction_invoke("OP_TRY_INVOKE", bytecode, offset) + 1;
+            return jml_bytecode_instruction_invoke("OP_TRY_INVOKE", bytecode, offset);
 
         case EXTENDED_OP(OP_TRY_INVOKE):
-            return jml_bytecode_instruction_invoke_extended("OP_TRY_INVOKE_EXTENDED", bytecode, offset) + 1;
+            return jml_bytecode_instruction_invoke_extended("OP_TRY_INVOKE_EXTENDED", bytecode, offset);
+
+        case OP_TAIL_INVOKE:
+            return jml_bytecode_instruction_invoke("OP_TAIL_INVOKE", bytecode, offset);
+
+        case EXTENDED_OP(OP_TAIL_INVOKE):
+            return jml_bytecode_instruction_invoke_extended("OP_TAIL_INVOKE_EXTENDED", bytecode, offset);
 
         case OP_SUPER_INVOKE:
             return jml_bytecode_instruction_invoke("OP_SUPER_INVOKE", bytecode, offset);
@@ -416,18 +503,18 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
             return jml_bytecode_instruction_invoke_extended("OP_SUPER_INVOKE_EXTENDED", bytecode, offset);
 
         case OP_TRY_SUPER_INVOKE:
-            return jml_bytecode_instruction_invoke("OP_TRY_SUPER_INVOKE", bytecode, offset) + 1;
+            return jml_bytecode_instruction_invoke("OP_TRY_SUPER_INVOKE", bytecode, offset);
 
         case EXTENDED_OP(OP_TRY_SUPER_INVOKE):
-            return jml_bytecode_instruction_invoke_extended("OP_TRY_SUPER_INVOKE_EXTENDED", bytecode, offset) + 1;
+            return jml_bytecode_instruction_invoke_extended("OP_TRY_SUPER_INVOKE_EXTENDED", bytecode, offset);
 
         case OP_CLOSURE: {
             ++offset;
             uint8_t constant    = bytecode->code[offset++];
 
-            printf("%-16s %4d   ", "OP_CLOSURE", constant);
+            jml_output_printf("%-16s %4d   ", "OP_CLOSURE", constant);
             jml_value_print(bytecode->constants.values[constant]);
-            printf("\n");
+            jml_output_printf("\n");
 
             jml_obj_function_t *function = AS_FUNCTION(bytecode->constants.values[constant]);
 
@@ -435,8 +522,8 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
                 uint8_t local       = bytecode->code[offset++];
                 uint8_t index       = bytecode->code[offset++];
 
-                printf("%04d       |    %-16s %4d\n",
-                    offset - 2, local ? "local" : "upvalue", index);
+                jml_output_printf("%04d       |    %-16s %4d\n",
+                    offset - 2, jml_bytecode_capture_name(local), index);
             }
             return offset;
         }
@@ -446,9 +533,9 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
             uint16_t constant   = (uint16_t)(bytecode->code[offset++] << 8);
             constant            |= bytecode->code[offset++];
 
-            printf("%-16s %4d   ", "OP_CLOSURE_EXTENDED", constant);
+            jml_output_printf("%-16s %4d   ", "OP_CLOSURE_EXTENDED", constant);
             jml_value_print(bytecode->constants.values[constant]);
-            printf("\n");
+            jml_output_printf("\n");
 
             jml_obj_function_t *function = AS_FUNCTION(bytecode->constants.values[constant]);
 
@@ -456,8 +543,8 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
                 uint8_t local = bytecode->code[offset++];
                 uint8_t index = bytecode->code[offset++];
 
-                printf("%04d       |    %-16s %4d\n",
-                    offset - 2, local ? "local" : "upvalue", index);
+                jml_output_printf("%04d       |    %-16s %4d\n",
+                    offset - 2, jml_bytecode_capture_name(local), index);
             }
             return offset;
         }
@@ -552,6 +639,15 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_GET_INDEX:
             return jml_bytecode_instruction_simple("OP_GET_INDEX", offset);
 
+        case OP_ITER_INIT:
+            return jml_bytecode_instruction_simple("OP_ITER_INIT", offset);
+
+        case OP_ITER_NEXT:
+            return jml_bytecode_instruction_bytes("OP_ITER_NEXT", bytecode, offset);
+
+        case OP_ITER_CHECK:
+            return jml_bytecode_instruction_iter("OP_ITER_CHECK", bytecode, offset);
+
         case OP_SWAP_GLOBAL:
             return jml_bytecode_instruction_triple("OP_SWAP_GLOBAL", bytecode, offset);
 
@@ -595,7 +691,7 @@ jml_bytecode_instruction_disassemble(jml_bytecode_t *bytecode, uint32_t offset)
             return jml_bytecode_instruction_simple("OP_END", offset);
 
         default:
-            printf("unknown opcode %d\n", instruction);
+            jml_output_printf("unknown opcode %d\n", instruction);
             return offset + 1;
     }
 }
@@ -636,6 +732,7 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_CLOSE_UPVALUE:
         case OP_SET_INDEX:
         case OP_GET_INDEX:
+        case OP_ITER_INIT:
         case OP_END:
             return 1;
 
@@ -646,6 +743,8 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_GET_MEMBER:
         case OP_SUPER:
         case OP_CALL:
+        case OP_TRY_CALL:
+        case OP_TAIL_CALL:
         case OP_SET_LOCAL:
         case OP_GET_LOCAL:
         case OP_SET_UPVALUE:
@@ -664,8 +763,9 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_JUMP:
         case OP_JUMP_IF_FALSE:
         case OP_LOOP:
-        case OP_TRY_CALL:
+        case OP_ITER_NEXT:
         case OP_INVOKE:
+        case OP_TAIL_INVOKE:
         case OP_SUPER_INVOKE:
         case EXTENDED_OP(OP_CONST):
         case EXTENDED_OP(OP_CLASS):
@@ -684,6 +784,7 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
         case OP_SWAP_GLOBAL:
         case OP_SWAP_LOCAL:
         case OP_IMPORT_WILDCARD:
+        case OP_ITER_CHECK:
             return 4;
 
         case EXTENDED_OP(OP_SET_GLOBAL):
@@ -691,6 +792,7 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
         case EXTENDED_OP(OP_DEF_GLOBAL):
         case EXTENDED_OP(OP_DEL_GLOBAL):
         case EXTENDED_OP(OP_INVOKE):
+        case EXTENDED_OP(OP_TAIL_INVOKE):
         case EXTENDED_OP(OP_SUPER_INVOKE):
         case EXTENDED_OP(OP_IMPORT):
         case EXTENDED_OP(OP_TRY_INVOKE):
@@ -703,7 +805,7 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
 
         case OP_CLOSURE: {
             uint32_t out        = 1;
-            uint8_t constant    = bytecode->code[out++];
+            uint8_t constant    = bytecode->code[offset + out++];
 
             jml_obj_function_t *function = AS_FUNCTION(
                 bytecode->constants.values[constant]);
@@ -713,8 +815,8 @@ jml_bytecode_instruction_offset(jml_bytecode_t *bytecode, uint32_t offset)
 
         case EXTENDED_OP(OP_CLOSURE): {
             uint32_t out        = 1;
-            uint16_t constant   = (bytecode->code[out++] << 8);
-            constant            |= bytecode->code[out++];
+            uint16_t constant   = (bytecode->code[offset + out++] << 8);
+            constant            |= bytecode->code[offset + out++];
 
             jml_obj_function_t *function = AS_FUNCTION(
                 bytecode->constants.values[constant]);
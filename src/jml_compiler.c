@@ -98,6 +98,7 @@ jml_parser_error_at(jml_compiler_t *compiler,
         return;
 
     if (compiler->output) {
+        jml_output_flush();
         fprintf(stderr, "[line %d", token->line);
 
         if (compiler->module != NULL) {
@@ -213,6 +214,15 @@ jml_parser_check(jml_parser_t *parser, jml_token_type type)
 }
 
 
+/*looks one token past the current one*/
+static bool
+jml_parser_check_next(jml_parser_t *parser, jml_token_type type)
+{
+    jml_lexer_t lexer = parser->lexer;
+    return jml_lexer_tokenize(&lexer).type == type;
+}
+
+
 static void
 jml_parser_consume(jml_compiler_t *compiler,
     jml_token_type type, const char *message)
@@ -397,6 +407,7 @@ jml_compiler_init(jml_compiler_t *compiler, jml_compiler_t *enclosing,
     compiler->klass         = enclosing != NULL ? enclosing->klass : NULL;
 
     compiler->local_count   = 0;
+    compiler->capture_count = 0;
     compiler->scope_depth   = 0;
     compiler->function      = jml_obj_function_new();
 
@@ -424,6 +435,7 @@ jml_compiler_init(jml_compiler_t *compiler, jml_compiler_t *enclosing,
     jml_local_t *local      = &compiler->locals[compiler->local_count++];
     local->depth            = 0;
     local->captured         = false;
+    local->assigned         = false;
 
     if (type == FUNCTION_METHOD || type == FUNCTION_INIT) {
         local->name.start   = "self";
@@ -434,6 +446,8 @@ jml_compiler_init(jml_compiler_t *compiler, jml_compiler_t *enclosing,
     }
 
     compiler->loop          = NULL;
+    compiler->last_call     = -1;
+    compiler->handler_depth = 0;
     compiler->output        = output;
 
     compiler->module        = module;
@@ -444,12 +458,42 @@ jml_compiler_init(jml_compiler_t *compiler, jml_compiler_t *enclosing,
 }
 
 
+/*
+ * a captured local that is never assigned can't be observed
+ * changing, so closures get a copy of its value instead of
+ * sharing an open upvalue with the frame
+*/
+static bool
+jml_capture_flatten(jml_compiler_t *compiler, int local)
+{
+    bool flat = !compiler->locals[local].assigned;
+
+    for (int i = compiler->capture_count - 1; i >= 0; --i) {
+        jml_capture_t *capture = &compiler->captures[i];
+        if (capture->local != local)
+            continue;
+
+        if (flat)
+            capture->function->bytecode.code[capture->offset] |= CAPTURE_COPY;
+
+        *capture = compiler->captures[--compiler->capture_count];
+    }
+
+    return flat;
+}
+
+
 static jml_obj_function_t *
 jml_compiler_end(jml_compiler_t *compiler)
 {
     jml_bytecode_emit_return(compiler);
     jml_bytecode_emit_byte(compiler, OP_END);
 
+    for (int i = compiler->local_count - 1; i >= 0; --i) {
+        if (compiler->locals[i].captured)
+            jml_capture_flatten(compiler, i);
+    }
+
     jml_obj_function_t *function = compiler->function;
 
 #ifdef JML_DISASSEMBLE
@@ -492,7 +536,8 @@ jml_scope_end(jml_compiler_t *compiler)
     while (compiler->local_count > 0
         && compiler->locals[compiler->local_count - 1].depth > compiler->scope_depth) {
 
-        if (compiler->locals[compiler->local_count - 1].captured)
+        if (compiler->locals[compiler->local_count - 1].captured
+            && !jml_capture_flatten(compiler, compiler->local_count - 1))
             jml_bytecode_emit_byte(compiler, OP_CLOSE_UPVALUE);
 
         else
@@ -545,6 +590,7 @@ jml_local_add(jml_compiler_t *compiler, jml_token_t name)
     local->name         = name;
     local->depth        = -1;
     local->captured     = false;
+    local->assigned     = false;
 }
 
 
@@ -628,6 +674,54 @@ jml_upvalue_resolve(jml_compiler_t *compiler,
 }
 
 
+/*follows an upvalue down to the local it was captured from*/
+static int
+jml_upvalue_origin(jml_compiler_t **compiler, int upvalue)
+{
+    while (!(*compiler)->upvalues[upvalue].local) {
+        upvalue    = (*compiler)->upvalues[upvalue].index;
+        *compiler  = (*compiler)->enclosing;
+    }
+
+    upvalue        = (*compiler)->upvalues[upvalue].index;
+    *compiler      = (*compiler)->enclosing;
+    return upvalue;
+}
+
+
+static void
+jml_capture_add(jml_compiler_t *compiler,
+    jml_compiler_t *sub_compiler, int upvalue)
+{
+    jml_compiler_t *owner   = sub_compiler;
+    int local               = jml_upvalue_origin(&owner, upvalue);
+
+    if (owner->capture_count == LOCAL_MAX) {
+        owner->locals[local].assigned = true;
+        return;
+    }
+
+    jml_capture_t *capture  = &owner->captures[owner->capture_count++];
+    capture->function       = compiler->function;
+    capture->offset         = jml_bytecode_current(compiler)->count;
+    capture->local          = local;
+}
+
+
+static void
+jml_variable_mutated(jml_compiler_t *compiler,
+    uint8_t set_op, int arg)
+{
+    if (set_op == OP_SET_LOCAL || set_op == EXTENDED_OP(OP_SET_LOCAL))
+        compiler->locals[arg].assigned = true;
+
+    else if (set_op == OP_SET_UPVALUE || set_op == EXTENDED_OP(OP_SET_UPVALUE)) {
+        int local = jml_upvalue_origin(&compiler, arg);
+        compiler->locals[local].assigned = true;
+    }
+}
+
+
 static void
 jml_loop_begin(jml_compiler_t *compiler, jml_loop_t *loop,
     int start, int body, int exit)
@@ -893,6 +987,8 @@ static void
 jml_call(jml_compiler_t *compiler, JML_UNUSED(bool assignable))
 {
     uint8_t arg_count = jml_arguments_list(compiler);
+
+    compiler->last_call     = jml_bytecode_current(compiler)->count;
     jml_bytecode_emit_bytes(compiler, OP_CALL, arg_count);
 }
 
@@ -914,6 +1010,8 @@ jml_dot(jml_compiler_t *compiler, bool assignable)
 
     } else if (jml_parser_match(compiler, TOKEN_LPAREN)) {
         uint16_t arg_count = jml_arguments_list(compiler);
+
+        compiler->last_call = jml_bytecode_current(compiler)->count;
         EMIT_EXTENDED_OP2(
             compiler, OP_INVOKE, EXTENDED_OP(OP_INVOKE), name, arg_count
         );
@@ -1239,6 +1337,7 @@ jml_variable_assignment(jml_compiler_t *compiler, bool index, bool global,
         jml_expression(compiler);
 
         jml_bytecode_emit_byte(compiler, op);
+        jml_variable_mutated(compiler, set_op, arg);
 
         if (global)
             EMIT_EXTENDED_OP2(compiler, set_op, set_op, compiler->module_const, arg);
@@ -1297,8 +1396,10 @@ jml_variable_named(jml_compiler_t *compiler,
             jml_bytecode_emit_byte(compiler, OP_SET_INDEX);
         else if (global)
             EMIT_EXTENDED_OP2(compiler, set_op, set_op, compiler->module_const, arg);
-        else
+        else {
+            jml_variable_mutated(compiler, set_op, arg);
             EMIT_EXTENDED_OP1(compiler, set_op, set_op, arg);
+        }
 
     } else if (assignable
         && jml_parser_match(compiler, TOKEN_COLCOLONEQ)) {
@@ -1532,7 +1633,8 @@ jml_lambda(jml_compiler_t *compiler, JML_UNUSED(bool assignable))
     );
 
     for (uint32_t i = 0; i < function->upvalue_count; ++i) {
-        jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].local ? 1 : 0);
+        jml_capture_add(compiler, &sub_compiler, i);
+        jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].local ? CAPTURE_LOCAL : 0);
         jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].index);
     }
 }
@@ -1543,12 +1645,23 @@ jml_piping(jml_compiler_t *compiler, JML_UNUSED(bool assignable))
 {
     jml_parser_precedence_parse(compiler, PREC_CALL + 1);
 
+    /*a member path such as module.function is a valid target*/
+    while (jml_parser_match(compiler, TOKEN_DOT)) {
+        jml_parser_consume(compiler, TOKEN_NAME, "Expect identifier after '.'.");
+        uint16_t name = jml_identifier_const(compiler, &compiler->parser->previous);
+
+        EMIT_EXTENDED_OP1(
+            compiler, OP_GET_MEMBER, EXTENDED_OP(OP_GET_MEMBER), name
+        );
+    }
+
     jml_bytecode_emit_byte(compiler, OP_ROT);
     uint8_t arg_count = 1;
 
     if (jml_parser_match(compiler, TOKEN_LPAREN))
         arg_count += jml_arguments_list(compiler);
 
+    compiler->last_call     = jml_bytecode_current(compiler)->count;
     jml_bytecode_emit_bytes(compiler, OP_CALL, arg_count);
 }
 
@@ -1557,27 +1670,31 @@ static void
 jml_try(jml_compiler_t *compiler, JML_UNUSED(bool assignable))
 {
     jml_parser_precedence_parse(compiler, PREC_CALL);
-    int count = jml_bytecode_current(compiler)->count;
+    jml_bytecode_t *bytecode    = jml_bytecode_current(compiler);
+    int count                   = bytecode->count;
+    int start                   = -1;
 
-    if (count >= 2 && jml_bytecode_current(compiler)->code[count - 2] == OP_CALL)
-        jml_bytecode_current(compiler)->code[count - 2] = OP_TRY_CALL;
+    if (count >= 2 && bytecode->code[count - 2] == OP_CALL)
+        bytecode->code[start = count - 2] = OP_TRY_CALL;
 
-    else if (count >= 3 && jml_bytecode_current(compiler)->code[count - 3] == OP_INVOKE)
-        jml_bytecode_current(compiler)->code[count - 3] = OP_TRY_INVOKE;
+    else if (count >= 3 && bytecode->code[count - 3] == OP_INVOKE)
+        bytecode->code[start = count - 3] = OP_TRY_INVOKE;
 
-    else if (count >= 5 && jml_bytecode_current(compiler)->code[count - 5] == EXTENDED_OP(OP_INVOKE))
-        jml_bytecode_current(compiler)->code[count - 5] = EXTENDED_OP(OP_TRY_INVOKE);
+    else if (count >= 5 && bytecode->code[count - 5] == EXTENDED_OP(OP_INVOKE))
+        bytecode->code[start = count - 5] = EXTENDED_OP(OP_TRY_INVOKE);
 
-    else if (count >= 3 && jml_bytecode_current(compiler)->code[count - 3] == OP_SUPER_INVOKE)
-        jml_bytecode_current(compiler)->code[count - 3] = OP_TRY_SUPER_INVOKE;
+    else if (count >= 3 && bytecode->code[count - 3] == OP_SUPER_INVOKE)
+        bytecode->code[start = count - 3] = OP_TRY_SUPER_INVOKE;
 
-    else if (count >= 5 && jml_bytecode_current(compiler)->code[count - 5] == EXTENDED_OP(OP_SUPER_INVOKE))
-        jml_bytecode_current(compiler)->code[count - 5] = EXTENDED_OP(OP_TRY_SUPER_INVOKE);
+    else if (count >= 5 && bytecode->code[count - 5] == EXTENDED_OP(OP_SUPER_INVOKE))
+        bytecode->code[start = count - 5] = EXTENDED_OP(OP_TRY_SUPER_INVOKE);
 
-    else
+    else {
         jml_parser_error(compiler, "Expect function call after 'try'.");
+        return;
+    }
 
-    jml_bytecode_emit_byte(compiler, compiler->local_count);
+    jml_bytecode_add_handler(bytecode, start, count, HANDLER_CALL, 0);
 }
 
 
@@ -1649,6 +1766,7 @@ static jml_parser_rule rules[] = {
     /*TOKEN_ASYNC*/     {NULL,          NULL,           PREC_NONE},
     /*TOKEN_AWAIT*/     {NULL,          NULL,           PREC_NONE},
     /*TOKEN_TRY*/       {&jml_try,      NULL,           PREC_CALL},
+    /*TOKEN_CATCH*/     {NULL,          NULL,           PREC_NONE},
     /*TOKEN_SPREAD*/    {NULL,          NULL,           PREC_NONE},
     /*TOKEN_AND*/       {NULL,          &jml_and,       PREC_AND},
     /*TOKEN_NOT*/       {&jml_unary,    NULL,           PREC_NONE},
@@ -1804,7 +1922,8 @@ jml_function(jml_compiler_t *compiler, jml_function_type type)
     );
 
     for (uint32_t i = 0; i < function->upvalue_count; ++i) {
-        jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].local ? 1 : 0);
+        jml_capture_add(compiler, &sub_compiler, i);
+        jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].local ? CAPTURE_LOCAL : 0);
         jml_bytecode_emit_byte(compiler, sub_compiler.upvalues[i].index);
     }
 }
@@ -2027,6 +2146,31 @@ jml_expression_statement(jml_compiler_t *compiler)
 }
 
 
+/*a call in tail position replaces the frame of the caller*/
+static void
+jml_tail_call(jml_compiler_t *compiler)
+{
+    jml_bytecode_t *bytecode    = jml_bytecode_current(compiler);
+    int             call        = compiler->last_call;
+
+    /*the frame is still needed by the handlers around it*/
+    if (call < 0 || compiler->handler_depth > 0)
+        return;
+
+    uint8_t        *op          = &bytecode->code[call];
+    uint32_t        length      = bytecode->count - call;
+
+    if (length == 2 && *op == OP_CALL)
+        *op                     = OP_TAIL_CALL;
+
+    else if (length == 3 && *op == OP_INVOKE)
+        *op                     = OP_TAIL_INVOKE;
+
+    else if (length == 5 && *op == EXTENDED_OP(OP_INVOKE))
+        *op                     = EXTENDED_OP(OP_TAIL_INVOKE);
+}
+
+
 static void
 jml_return_statement(jml_compiler_t *compiler)
 {
@@ -2049,6 +2193,8 @@ jml_return_statement(jml_compiler_t *compiler)
     } else {
         jml_expression(compiler);
         jml_parser_newline(compiler, "Expect newline after 'return'.");
+
+        jml_tail_call(compiler);
         jml_bytecode_emit_byte(compiler, OP_RETURN);
     }
 }
@@ -2271,100 +2417,73 @@ jml_for_statement(jml_compiler_t *compiler)
     int local = jml_local_resolve(compiler, &compiler->parser->previous);
     jml_bytecode_emit_byte(compiler, OP_NONE);
 
+    /*key and value*/
+    int key = -1;
+    if (jml_parser_match(compiler, TOKEN_COMMA)) {
+        key = local;
+
+        jml_variable_parse(compiler, "Expect identifier after ','.");
+        jml_variable_definition(compiler, 0);
+        local = jml_local_resolve(compiler, &compiler->parser->previous);
+        jml_bytecode_emit_byte(compiler, OP_NONE);
+    }
+
     jml_parser_consume(compiler, TOKEN_IN, "Expect 'in' after 'for let'.");
 
     jml_token_t tok1 = jml_token_emit_synthetic(compiler->parser, "$$$_1");
     int iter = jml_local_add_synthetic(compiler, &tok1);
     jml_expression(compiler);
+    jml_bytecode_emit_byte(compiler, OP_ITER_INIT);
 
+    /*cursor*/
     jml_token_t tok2 = jml_token_emit_synthetic(compiler->parser, "$$$_2");
-    int index = jml_local_add_synthetic(compiler, &tok2);
+    jml_local_add_synthetic(compiler, &tok2);
     jml_bytecode_emit_const(compiler, NUM_VAL(0));
 
-    jml_token_t tok3 = jml_token_emit_synthetic(compiler->parser, "$$$_3");
-    int size = jml_local_add_synthetic(compiler, &tok3);
-
-    jml_gc_exempt_push(jml_string_intern("core"));
-    jml_gc_exempt_push(jml_string_intern("size"));
-
-    EMIT_EXTENDED_OP2(
-        compiler, OP_IMPORT, EXTENDED_OP(OP_IMPORT),
-        jml_bytecode_make_const(compiler, jml_gc_exempt_peek(1)),
-        jml_bytecode_make_const(compiler, jml_gc_exempt_peek(1))
-    );
-    EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), iter
-    );
-    EMIT_EXTENDED_OP2(
-        compiler, OP_INVOKE, EXTENDED_OP(OP_INVOKE),
-        jml_bytecode_make_const(compiler, jml_gc_exempt_peek(0)), 1
-    );
-
-    jml_gc_exempt_pop();
-    jml_gc_exempt_pop();
-
     int start = jml_bytecode_current(compiler)->count;
 
-    /*condition*/
-    EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), index
-    );
-    EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), size
-    );
-    jml_bytecode_emit_byte(compiler, OP_LESS);
-
-    int exit = jml_bytecode_emit_jump(compiler, OP_JUMP_IF_FALSE);
-    jml_bytecode_emit_byte(compiler, OP_POP);
+    /*the pair flag is an operand of OP_ITER_NEXT only*/
+    jml_bytecode_emit_bytes(compiler, OP_ITER_NEXT, iter);
+    jml_bytecode_emit_byte(compiler, key != -1);
 
-    /*increment*/
-    int body = jml_bytecode_emit_jump(compiler, OP_JUMP);
-    int increment = jml_bytecode_current(compiler)->count;
+    /*the jump offset follows the slot*/
+    jml_bytecode_emit_bytes(compiler, OP_ITER_CHECK, iter);
+    jml_bytecode_emit_bytes(compiler, 0xff, 0xff);
+    int exit = jml_bytecode_current(compiler)->count - 2;
 
     EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), index
+        compiler, OP_SET_LOCAL, EXTENDED_OP(OP_SET_LOCAL), local
     );
+    jml_bytecode_emit_byte(compiler, OP_POP);
 
-    jml_bytecode_emit_const(compiler, NUM_VAL(1));
-    jml_bytecode_emit_byte(compiler, OP_ADD);
+    /*the loop variables are shared by every iteration*/
+    compiler->locals[local].assigned = true;
+    if (key != -1)
+        compiler->locals[key].assigned = true;
 
-    EMIT_EXTENDED_OP1(
-        compiler, OP_SET_LOCAL, EXTENDED_OP(OP_SET_LOCAL), index
-    );
-    jml_bytecode_emit_byte(compiler, OP_POP);
+    if (key != -1) {
+        EMIT_EXTENDED_OP1(
+            compiler, OP_SET_LOCAL, EXTENDED_OP(OP_SET_LOCAL), key
+        );
+        jml_bytecode_emit_byte(compiler, OP_POP);
+    }
 
     jml_parser_consume(compiler, TOKEN_LBRACE, "Expect '{' before 'for' body.");
 
-    jml_bytecode_emit_loop(compiler, start);
-    start = increment;
-    jml_bytecode_patch_jump(compiler, body);
-
     /*body*/
     jml_loop_t loop;
     jml_loop_begin(
         compiler, &loop, start, jml_bytecode_current(compiler)->count, exit
     );
 
-    EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), iter
-    );
-    EMIT_EXTENDED_OP1(
-        compiler, OP_GET_LOCAL, EXTENDED_OP(OP_GET_LOCAL), index
-    );
-
-    jml_bytecode_emit_byte(compiler, OP_GET_INDEX);
-    EMIT_EXTENDED_OP1(
-        compiler, OP_SET_LOCAL, EXTENDED_OP(OP_SET_LOCAL), local
-    );
-    jml_bytecode_emit_byte(compiler, OP_POP);
-
+    /*body locals are fresh on every iteration*/
+    jml_scope_begin(compiler);
     jml_block(compiler);
+    jml_scope_end(compiler);
     jml_parser_newline(compiler, "Expect newline after 'for' block.");
 
     jml_bytecode_emit_loop(compiler, start);
-
     jml_bytecode_patch_jump(compiler, exit);
-    jml_bytecode_emit_byte(compiler, OP_POP);
 
     jml_loop_end(compiler);
     jml_scope_end(compiler);
@@ -2501,6 +2620,50 @@ jml_match_statement(jml_compiler_t *compiler)
 }
 
 
+static void
+jml_try_statement(jml_compiler_t *compiler)
+{
+    int depth   = compiler->local_count;
+    int start   = jml_bytecode_current(compiler)->count;
+
+    jml_parser_consume(compiler, TOKEN_LBRACE, "Expect '{' after 'try'.");
+
+    ++compiler->handler_depth;
+    jml_scope_begin(compiler);
+    jml_block(compiler);
+    jml_scope_end(compiler);
+    --compiler->handler_depth;
+
+    int end     = jml_bytecode_current(compiler)->count;
+    int exit    = jml_bytecode_emit_jump(compiler, OP_JUMP);
+    int target  = jml_bytecode_current(compiler)->count;
+
+    jml_parser_consume(compiler, TOKEN_CATCH, "Expect 'catch' after 'try' block.");
+
+    /*the vm pushes the exception right above the locals*/
+    jml_scope_begin(compiler);
+    if (jml_parser_match(compiler, TOKEN_USCORE)) {
+        jml_token_t tok1 = jml_token_emit_synthetic(compiler->parser, "$$$_1");
+        jml_local_add_synthetic(compiler, &tok1);
+
+    } else {
+        jml_parser_consume(compiler, TOKEN_NAME, "Expect identifier after 'catch'.");
+        jml_local_add_synthetic(compiler, &compiler->parser->previous);
+    }
+
+    jml_parser_consume(compiler, TOKEN_LBRACE, "Expect '{' after 'catch'.");
+    jml_block(compiler);
+    jml_scope_end(compiler);
+
+    jml_parser_newline(compiler, "Expect newline after 'catch' block.");
+    jml_bytecode_patch_jump(compiler, exit);
+
+    jml_bytecode_add_handler(
+        jml_bytecode_current(compiler), start, end, target, depth
+    );
+}
+
+
 static void
 jml_spread_statement(jml_compiler_t *compiler)
 {
@@ -2540,6 +2703,12 @@ jml_statement(jml_compiler_t *compiler)
     else if (jml_parser_match(compiler, TOKEN_SPREAD))
         jml_spread_statement(compiler);
 
+    else if (jml_parser_check(compiler->parser, TOKEN_TRY)
+        && jml_parser_check_next(compiler->parser, TOKEN_LBRACE)) {
+        jml_parser_advance(compiler);
+        jml_try_statement(compiler);
+    }
+
     else if (jml_parser_match(compiler, TOKEN_LBRACE)) {
         jml_scope_begin(compiler);
         jml_block(compiler);
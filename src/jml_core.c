@@ -10,78 +10,12 @@
 #include <jml/jml_util.h>
 #include <jml/jml_gc.h>
 #include <jml/jml_string.h>
+#include <jml/jml_format.h>
 
 #define JML_VM_INTERNAL
 #include <jml/jml_vm.h>
 
 
-static jml_value_t
-jml_core_format_internal(jml_value_t format,
-    int arg_count, jml_value_t *args)
-{
-    jml_obj_string_t *fmt_obj   = AS_STRING(format);
-    char             *fmt_str   = jml_strdup(fmt_obj->chars);
-    int32_t           fmt_args  = 0;
-    int32_t           fmt_extra = 0;
-    int32_t           fmt_err   = 0;
-
-    size_t            size      = (fmt_obj->length + 1) + arg_count * 16;
-    size_t            dest_size = size;
-
-    char             *buffer    = jml_alloc(size);
-    char             *save      = NULL;
-    char             *token     = jml_strtok(fmt_str, "{}", &save);
-    char             *last      = token;
-
-    while (token != NULL) {
-        if (fmt_args >= arg_count)
-            ++fmt_extra;
-        else {
-            char *value_str     = jml_value_stringify(args[fmt_args]);
-
-            dest_size          += strlen(value_str) + strlen(token);
-            REALLOC(char, buffer, size, dest_size);
-
-            jml_strcat(jml_strcat(buffer, token), value_str);
-
-            jml_free(value_str);
-        }
-
-        ++fmt_args;
-        last                    = token;
-        token                   = jml_strtok(NULL, "{}", &save);
-    }
-
-    fmt_err                     = fmt_args;
-
-    if (fmt_obj->length < 2
-        || !(fmt_obj->chars[fmt_obj->length - 1] == '}'
-        && fmt_obj->chars[fmt_obj->length - 2] == '{')) {
-
-        --fmt_err;
-        --fmt_extra;
-        jml_strcat(buffer, last);
-    }
-
-    jml_free(fmt_str);
-
-    if (fmt_extra > 0 || fmt_err != arg_count) {
-        jml_free(buffer);
-        return OBJ_VAL(
-            jml_obj_exception_format(
-                "FormatErr",
-                "Expected '%d' format arguments but got '%d'.",
-                fmt_err, arg_count
-            )
-        );
-    }
-
-    return OBJ_VAL(
-        jml_obj_string_take(buffer, strlen(buffer))
-    );
-}
-
-
 static jml_value_t
 jml_core_format(int arg_count, jml_value_t *args)
 {
@@ -97,8 +31,8 @@ jml_core_format(int arg_count, jml_value_t *args)
         );
     }
 
-    return jml_core_format_internal(
-        args[0], arg_count - 1, args + 1
+    return jml_format(
+        AS_STRING(args[0]), arg_count - 1, args + 1
     );
 }
 
@@ -125,8 +59,8 @@ jml_core_format_array(int arg_count, jml_value_t *args)
     }
 
     jml_obj_array_t *array = AS_ARRAY(args[1]);
-    return jml_core_format_internal(
-        args[0],
+    return jml_format(
+        AS_STRING(args[0]),
         array->values.count,
         array->values.values
     );
@@ -137,18 +71,28 @@ static jml_value_t
 jml_core_print_fmt(int arg_count, jml_value_t *args)
 {
     if (arg_count == 0) {
-        printf("\n");
+        jml_output_write("\n", 1);
         return NONE_VAL;
     }
 
-    jml_value_t fmt = jml_core_format(arg_count, args);
-
-    if (IS_STRING(fmt)) {
-        printf("%.*s", (int32_t)AS_STRING(fmt)->length, AS_CSTRING(fmt));
-        return NONE_VAL;
+    if (!IS_STRING(args[0])) {
+        return OBJ_VAL(
+            jml_obj_exception_new("FormatErr", "Expected format string.")
+        );
     }
 
-    return fmt;
+    /*the output is never interned*/
+    jml_obj_exception_t *exc = NULL;
+    jml_strbuf_t         buf;
+
+    jml_strbuf_init(&buf, AS_STRING(args[0])->length + arg_count * 16);
+
+    if (jml_format_write(&buf, AS_STRING(args[0]),
+        arg_count - 1, args + 1, &exc))
+        jml_output_write(buf.chars, buf.length);
+
+    jml_strbuf_free(&buf);
+    return exc != NULL ? OBJ_VAL(exc) : NONE_VAL;
 }
 
 
@@ -156,17 +100,17 @@ static jml_value_t
 jml_core_print_ln(int arg_count, jml_value_t *args)
 {
     if (arg_count == 0) {
-        printf("\n");
+        jml_output_write("\n", 1);
         return NONE_VAL;
     }
 
     for (int i = 0; i < arg_count; ++i) {
         if (IS_STRING(args[i]))
-            printf("%.*s", (int32_t)AS_STRING(args[i])->length, AS_CSTRING(args[i]));
+            jml_output_write(AS_CSTRING(args[i]), AS_STRING(args[i])->length);
         else
             jml_value_print(args[i]);
 
-        printf("\n");
+        jml_output_write("\n", 1);
     }
 
     return NONE_VAL;
@@ -177,13 +121,13 @@ static jml_value_t
 jml_core_print(int arg_count, jml_value_t *args)
 {
     if (arg_count == 0) {
-        printf("\n");
+        jml_output_write("\n", 1);
         return NONE_VAL;
     }
 
     for (int i = 0; i < arg_count; ++i) {
         if (IS_STRING(args[i]))
-            printf("%.*s", (int32_t)AS_STRING(args[i])->length, AS_CSTRING(args[i]));
+            jml_output_write(AS_CSTRING(args[i]), AS_STRING(args[i])->length);
         else
             jml_value_print(args[i]);
     }
@@ -192,6 +136,101 @@ jml_core_print(int arg_count, jml_value_t *args)
 }
 
 
+static jml_value_t
+jml_core_flush(int arg_count, JML_UNUSED(jml_value_t *args))
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 0);
+
+    if (exc != NULL)
+        return OBJ_VAL(exc);
+
+    jml_output_flush();
+    return NONE_VAL;
+}
+
+
+static jml_value_t
+jml_core_recursion_limit(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+    uint32_t             previous = vm->recursion_limit;
+
+    if (arg_count > 1) {
+        exc = jml_error_args(
+            arg_count, 1);
+        goto err;
+    }
+
+    if (arg_count == 1) {
+        if (!IS_NUM(args[0])) {
+            exc = jml_error_types(false, 1, "number");
+            goto err;
+        }
+
+        double limit = AS_NUM(args[0]);
+
+        if (!(limit >= 1 && limit <= UINT32_MAX)) {
+            exc = jml_error_value("recursion limit");
+            goto err;
+        }
+
+        vm->recursion_limit = (uint32_t)limit;
+    }
+
+    return NUM_VAL(previous);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static const char *const jml_core_output_modes[] = {
+    [OUTPUT_LINE]                   = "line",
+    [OUTPUT_BLOCK]                  = "block",
+    [OUTPUT_EXPLICIT]               = "explicit"
+};
+
+
+static jml_value_t
+jml_core_buffering(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+    jml_output_mode      mode = jml_output_get_mode();
+    const char          *previous = jml_core_output_modes[mode];
+
+    if (arg_count > 1) {
+        exc = jml_error_args(
+            arg_count, 1);
+        goto err;
+    }
+
+    if (arg_count == 1) {
+        if (!IS_STRING(args[0])) {
+            exc = jml_error_types(false, 1, "string");
+            goto err;
+        }
+
+        for (mode = OUTPUT_LINE; mode <= OUTPUT_EXPLICIT; ++mode) {
+            if (strcmp(AS_CSTRING(args[0]), jml_core_output_modes[mode]) == 0)
+                break;
+        }
+
+        if (mode > OUTPUT_EXPLICIT) {
+            exc = jml_error_value("buffering mode");
+            goto err;
+        }
+
+        jml_output_set_mode(mode);
+    }
+
+    return jml_string_intern(previous);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
 static jml_value_t
 jml_core_repr(int arg_count, jml_value_t *args)
 {
@@ -201,9 +240,12 @@ jml_core_repr(int arg_count, jml_value_t *args)
     if (exc != NULL)
         return OBJ_VAL(exc);
 
-    char *repr = jml_value_stringify(args[0]);
+    jml_strbuf_t buf;
+    jml_strbuf_init(&buf, 32);
+    jml_value_write(&buf, args[0]);
+
     return OBJ_VAL(
-        jml_obj_string_take(repr, strlen(repr))
+        jml_obj_string_take(buf.chars, buf.length)
     );
 }
 
@@ -320,6 +362,9 @@ jml_core_size(int arg_count, jml_value_t *args)
         case OBJ_ARRAY:
             return NUM_VAL(AS_ARRAY(value)->values.count);
 
+        case OBJ_BUFFER:
+            return NUM_VAL(jml_obj_buffer_count(AS_BUFFER(value)));
+
         case OBJ_MAP:
             return NUM_VAL(AS_MAP(value)->hashmap.count);
 
@@ -365,6 +410,566 @@ err:
 }
 
 
+/*
+ * callables other than cfunctions run on a
+ * single coroutine reused for the whole builtin
+ */
+static jml_obj_coroutine_t *
+jml_core_caller(jml_value_t callee)
+{
+    if (IS_CFUNCTION(callee))
+        return NULL;
+
+    jml_obj_coroutine_t *coroutine      = jml_obj_coroutine_new(NULL);
+    jml_gc_exempt_push(OBJ_VAL(coroutine));
+
+    return coroutine;
+}
+
+
+static jml_value_t
+jml_core_apply(jml_obj_coroutine_t *coroutine, jml_value_t callee,
+    int arg_count, jml_value_t *args)
+{
+    if (coroutine == NULL)
+        return jml_obj_cfunction_call(AS_CFUNCTION(callee), arg_count, args);
+
+    jml_value_t result                  = NONE_VAL;
+
+    /*an exception from the callback is passed on as it is*/
+    if (!jml_vm_callback(coroutine, callee, arg_count, args, &result)
+        && !IS_EXCEPTION(result))
+        return OBJ_VAL(jml_obj_exception_new(
+            "CallErr", "Callback raised an error."
+        ));
+
+    return result;
+}
+
+
+/*negative indices count from the end, nan and anything past either end fail*/
+static bool
+jml_core_index(jml_value_t value, int32_t count, int32_t *index)
+{
+    double number                       = AS_NUM(value);
+
+    if (!(number >= -count && number <= count))
+        return false;
+
+    if (number < 0)
+        number                         += count;
+
+    *index                              = (int32_t)number;
+    return true;
+}
+
+
+static jml_value_t
+jml_core_slice(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = NULL;
+
+    if (arg_count < 2 || arg_count > 3) {
+        exc = jml_error_args(arg_count, 2);
+        goto err;
+    }
+
+    if (!IS_ARRAY(args[0]) || !IS_NUM(args[1])
+        || (arg_count > 2 && !IS_NUM(args[2]))) {
+
+        exc = jml_error_types(false, 3, "array", "number", "number");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    int32_t count                       = array->values.count;
+
+    int32_t start;
+    int32_t end                         = count;
+
+    if (!jml_core_index(args[1], count, &start)
+        || (arg_count > 2 && !jml_core_index(args[2], count, &end))) {
+
+        exc = jml_obj_exception_new(
+            "RangeErr", "Slice index out of range."
+        );
+        goto err;
+    }
+
+    jml_obj_array_t *slice              = jml_obj_array_new();
+
+    if (end > start) {
+        jml_gc_exempt_push(OBJ_VAL(slice));
+        jml_value_array_extend(&slice->values,
+            array->values.values + start, end - start);
+        jml_gc_exempt_pop();
+    }
+
+    return OBJ_VAL(slice);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_core_extend(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_ARRAY(args[0]) || !IS_ARRAY(args[1])) {
+        exc = jml_error_types(false, 2, "array", "array");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    jml_obj_array_t *other              = AS_ARRAY(args[1]);
+
+    jml_value_array_extend(&array->values,
+        other->values.values, other->values.count);
+
+    return OBJ_VAL(array);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_core_reserve(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_ARRAY(args[0]) || !IS_NUM(args[1]) || AS_NUM(args[1]) < 0) {
+        exc = jml_error_types(false, 2, "array", "number");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    double capacity                     = AS_NUM(args[1]);
+
+    if (capacity > INT32_MAX) {
+        exc = jml_obj_exception_new(
+            "RangeErr", "Capacity too large."
+        );
+        goto err;
+    }
+
+    jml_value_array_reserve(&array->values, (int)capacity);
+    return OBJ_VAL(array);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*sort*/
+typedef struct {
+    jml_value_t                         compare;
+    jml_obj_coroutine_t                *coroutine;
+    jml_value_t                         error;
+} jml_core_sort_t;
+
+
+static bool
+jml_core_sort_less(jml_core_sort_t *sort,
+    jml_value_t a, jml_value_t b)
+{
+    if (!IS_NONE(sort->error))
+        return false;
+
+    if (IS_NONE(sort->compare)) {
+        if (IS_NUM(a) && IS_NUM(b))
+            return AS_NUM(a) < AS_NUM(b);
+
+        if (IS_STRING(a) && IS_STRING(b)) {
+            jml_obj_string_t *left      = AS_STRING(a);
+            jml_obj_string_t *right     = AS_STRING(b);
+            size_t length               = left->length < right->length
+                ? left->length : right->length;
+
+            int order                   = memcmp(
+                left->chars, right->chars, length);
+
+            return order < 0
+                || (order == 0 && left->length < right->length);
+        }
+
+        sort->error                     = OBJ_VAL(jml_obj_exception_format(
+            "DiffTypes",
+            "Can't compare %s and %s.",
+            jml_value_stringify_type(a),
+            jml_value_stringify_type(b)
+        ));
+        return false;
+    }
+
+    jml_value_t pair[2]                 = {a, b};
+    jml_value_t result                  = jml_core_apply(
+        sort->coroutine, sort->compare, 2, pair);
+
+    if (IS_NUM(result))
+        return AS_NUM(result) < 0;
+
+    if (IS_BOOL(result))
+        return AS_BOOL(result);
+
+    sort->error                         = IS_EXCEPTION(result)
+        ? result
+        : OBJ_VAL(jml_obj_exception_new(
+            "DiffTypes", "Expected comparator to return a number."
+        ));
+
+    return false;
+}
+
+
+#define SORT_SWAP(a, b)                                 \
+    do {                                                \
+        jml_value_t temp    = (a);                      \
+        (a)                 = (b);                      \
+        (b)                 = temp;                     \
+    } while (false)
+
+
+static void
+jml_core_sort_insertion(jml_core_sort_t *sort,
+    jml_value_t *values, int32_t count)
+{
+    for (int32_t i = 1; i < count; ++i) {
+        jml_value_t value               = values[i];
+        int32_t j                       = i;
+
+        while (j > 0 && jml_core_sort_less(sort, value, values[j - 1])) {
+            values[j]                   = values[j - 1];
+            --j;
+        }
+
+        values[j]                       = value;
+    }
+}
+
+
+static void
+jml_core_sort_sift(jml_core_sort_t *sort,
+    jml_value_t *values, int32_t root, int32_t count)
+{
+    while (2 * root + 1 < count) {
+        int32_t child                   = 2 * root + 1;
+
+        if (child + 1 < count
+            && jml_core_sort_less(sort, values[child], values[child + 1]))
+            ++child;
+
+        if (!jml_core_sort_less(sort, values[root], values[child]))
+            return;
+
+        SORT_SWAP(values[root], values[child]);
+        root                            = child;
+    }
+}
+
+
+static void
+jml_core_sort_heap(jml_core_sort_t *sort,
+    jml_value_t *values, int32_t count)
+{
+    for (int32_t i = count / 2 - 1; i >= 0; --i)
+        jml_core_sort_sift(sort, values, i, count);
+
+    for (int32_t i = count - 1; i > 0; --i) {
+        SORT_SWAP(values[0], values[i]);
+        jml_core_sort_sift(sort, values, 0, i);
+    }
+}
+
+
+/*median of three is moved last, then lomuto partition*/
+static int32_t
+jml_core_sort_partition(jml_core_sort_t *sort,
+    jml_value_t *values, int32_t low, int32_t high)
+{
+    int32_t mid                         = low + (high - low) / 2;
+    int32_t last                        = high - 1;
+
+    if (jml_core_sort_less(sort, values[mid], values[low]))
+        SORT_SWAP(values[mid], values[low]);
+
+    if (jml_core_sort_less(sort, values[last], values[low]))
+        SORT_SWAP(values[last], values[low]);
+
+    if (jml_core_sort_less(sort, values[mid], values[last]))
+        SORT_SWAP(values[mid], values[last]);
+
+    jml_value_t pivot                   = values[last];
+    int32_t store                       = low;
+
+    for (int32_t i = low; i < last; ++i) {
+        if (jml_core_sort_less(sort, values[i], pivot)) {
+            SORT_SWAP(values[i], values[store]);
+            ++store;
+        }
+    }
+
+    SORT_SWAP(values[store], values[last]);
+    return store;
+}
+
+
+static void
+jml_core_sort_intro(jml_core_sort_t *sort,
+    jml_value_t *values, int32_t low, int32_t high, int depth)
+{
+    while (high - low > 16) {
+        if (!IS_NONE(sort->error))
+            return;
+
+        if (depth-- == 0) {
+            jml_core_sort_heap(sort, values + low, high - low);
+            return;
+        }
+
+        int32_t pivot                   = jml_core_sort_partition(
+            sort, values, low, high);
+
+        /*recurse on the smaller side*/
+        if (pivot - low < high - pivot - 1) {
+            jml_core_sort_intro(sort, values, low, pivot, depth);
+            low                         = pivot + 1;
+        } else {
+            jml_core_sort_intro(sort, values, pivot + 1, high, depth);
+            high                        = pivot;
+        }
+    }
+
+    jml_core_sort_insertion(sort, values + low, high - low);
+}
+
+
+static jml_value_t
+jml_core_sort(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = NULL;
+
+    if (arg_count < 1 || arg_count > 2) {
+        exc = jml_error_args(arg_count, 1);
+        goto err;
+    }
+
+    if (!IS_ARRAY(args[0])) {
+        exc = jml_error_types(false, 2, "array", "function");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+
+    jml_core_sort_t sort;
+    sort.compare                        = arg_count > 1 ? args[1] : NONE_VAL;
+    sort.coroutine                      = NULL;
+    sort.error                          = NONE_VAL;
+
+    /*a comparator could change the array while it is sorted*/
+    jml_obj_array_t *target             = array;
+
+    if (!IS_NONE(sort.compare)) {
+        sort.coroutine                  = jml_core_caller(sort.compare);
+
+        target                          = jml_obj_array_new();
+        jml_gc_exempt_push(OBJ_VAL(target));
+        jml_value_array_extend(&target->values,
+            array->values.values, array->values.count);
+    }
+
+    int32_t count                       = target->values.count;
+    int depth                           = 0;
+    for (int32_t n = count; n > 1; n >>= 1)
+        depth                          += 2;
+
+    jml_core_sort_intro(&sort, target->values.values, 0, count, depth);
+
+    if (!IS_NONE(sort.compare)) {
+        if (IS_NONE(sort.error)) {
+            array->values.count         = 0;
+            jml_value_array_extend(&array->values,
+                target->values.values, target->values.count);
+        }
+
+        jml_gc_exempt_pop();
+        if (sort.coroutine != NULL)
+            jml_gc_exempt_pop();
+    }
+
+    if (!IS_NONE(sort.error))
+        return sort.error;
+
+    return OBJ_VAL(array);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+#undef SORT_SWAP
+
+
+static jml_value_t
+jml_core_map(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_ARRAY(args[0])) {
+        exc = jml_error_types(false, 2, "array", "function");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    jml_obj_coroutine_t *coroutine      = jml_core_caller(args[1]);
+
+    jml_obj_array_t *result             = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(result));
+    jml_value_array_reserve(&result->values, array->values.count);
+
+    for (int i = 0; i < array->values.count; ++i) {
+        jml_value_t value               = jml_core_apply(
+            coroutine, args[1], 1, &array->values.values[i]);
+
+        if (IS_EXCEPTION(value)) {
+            jml_gc_exempt_pop();
+            if (coroutine != NULL)
+                jml_gc_exempt_pop();
+
+            return value;
+        }
+
+        jml_value_array_write(&result->values, value);
+    }
+
+    jml_gc_exempt_pop();
+    if (coroutine != NULL)
+        jml_gc_exempt_pop();
+
+    return OBJ_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_core_filter(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_ARRAY(args[0])) {
+        exc = jml_error_types(false, 2, "array", "function");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    jml_obj_coroutine_t *coroutine      = jml_core_caller(args[1]);
+
+    jml_obj_array_t *result             = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(result));
+
+    for (int i = 0; i < array->values.count; ++i) {
+        jml_value_t item                = array->values.values[i];
+        jml_value_t keep                = jml_core_apply(
+            coroutine, args[1], 1, &item);
+
+        if (IS_EXCEPTION(keep)) {
+            jml_gc_exempt_pop();
+            if (coroutine != NULL)
+                jml_gc_exempt_pop();
+
+            return keep;
+        }
+
+        if (!jml_value_falsey(keep))
+            jml_value_array_write(&result->values, item);
+    }
+
+    jml_gc_exempt_pop();
+    if (coroutine != NULL)
+        jml_gc_exempt_pop();
+
+    return OBJ_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_core_reduce(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = NULL;
+
+    if (arg_count < 2 || arg_count > 3) {
+        exc = jml_error_args(arg_count, 2);
+        goto err;
+    }
+
+    if (!IS_ARRAY(args[0])) {
+        exc = jml_error_types(false, 3, "array", "function", "value");
+        goto err;
+    }
+
+    jml_obj_array_t *array              = AS_ARRAY(args[0]);
+    int start                           = 0;
+    jml_value_t pair[2];
+
+    if (arg_count > 2)
+        pair[0]                         = args[2];
+    else if (array->values.count > 0)
+        pair[0]                         = array->values.values[start++];
+    else {
+        exc = jml_obj_exception_new(
+            "RangeErr", "Can't reduce empty array without initial value."
+        );
+        goto err;
+    }
+
+    jml_obj_coroutine_t *coroutine      = jml_core_caller(args[1]);
+    jml_gc_exempt_push(pair[0]);
+
+    for (int i = start; i < array->values.count; ++i) {
+        pair[1]                         = array->values.values[i];
+        pair[0]                         = jml_core_apply(
+            coroutine, args[1], 2, pair);
+
+        jml_gc_exempt_pop();
+        jml_gc_exempt_push(pair[0]);
+
+        if (IS_EXCEPTION(pair[0]))
+            break;
+    }
+
+    jml_gc_exempt_pop();
+    if (coroutine != NULL)
+        jml_gc_exempt_pop();
+
+    return pair[0];
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
 static jml_value_t
 jml_core_char(int arg_count, jml_value_t *args)
 {
@@ -525,6 +1130,9 @@ jml_core_attr(int arg_count, jml_value_t *args)
 
     switch (OBJ_TYPE(value)) {
         case OBJ_MODULE: {
+#ifdef JML_LAZY_IMPORT
+            jml_module_lazy_bind_all(AS_MODULE(value));
+#endif
             jml_obj_map_t *map      = jml_obj_map_new();
             jml_gc_exempt_push(OBJ_VAL(map));
             jml_hashmap_add(&AS_MODULE(value)->globals, &map->hashmap);
@@ -659,10 +1267,20 @@ static jml_module_function core_table[] = {
     {"printfmt",                    &jml_core_print_fmt},
     {"println",                     &jml_core_print_ln},
     {"print",                       &jml_core_print},
+    {"flush",                       &jml_core_flush},
+    {"buffering",                   &jml_core_buffering},
+    {"recursion_limit",             &jml_core_recursion_limit},
     {"repr",                        &jml_core_repr},
     {"char",                        &jml_core_char},
     {"reverse",                     &jml_core_reverse},
     {"size",                        &jml_core_size},
+    {"slice",                       &jml_core_slice},
+    {"extend",                      &jml_core_extend},
+    {"reserve",                     &jml_core_reserve},
+    {"sort",                        &jml_core_sort},
+    {"map",                         &jml_core_map},
+    {"filter",                      &jml_core_filter},
+    {"reduce",                      &jml_core_reduce},
     {"instance",                    &jml_core_instance},
     {"subclass",                    &jml_core_subclass},
     {"type",                        &jml_core_type},
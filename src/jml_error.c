@@ -6,34 +6,90 @@
 #include <jml/jml_gc.h>
 
 
-jml_obj_exception_t *
-jml_error_args(int arg_count, int expected_arg)
+/*
+ *messages are only rendered when somebody reads them,
+ *so exceptions caught by try never pay for the formatting
+ */
+static jml_obj_string_t *
+jml_error_args_render(jml_obj_exception_t *exc)
 {
     char message[128];
 
-    sprintf(message, "Expected '%d' arguments but got '%d'.",
-        expected_arg, arg_count);
+    int length = sprintf(message, "Expected '%d' arguments but got '%d'.",
+        (int)exc->detail[1], (int)exc->detail[0]);
+
+    return jml_obj_string_copy(message, length);
+}
+
+
+jml_obj_exception_t *
+jml_error_args(int arg_count, int expected_arg)
+{
+    jml_obj_exception_t *exc    = NULL;
 
     if (arg_count > expected_arg)
-        return jml_obj_exception_new(
-            "TooManyArgs", message);
+        exc = jml_obj_exception_lazy(
+            "TooManyArgs", jml_error_args_render);
+
+    else if (arg_count < expected_arg)
+        exc = jml_obj_exception_lazy(
+            "TooFewArgs", jml_error_args_render);
 
-    if (arg_count < expected_arg)
-        return jml_obj_exception_new(
-            "TooFewArgs", message);
+    else
+        return NULL;
 
-    return NULL;
+    exc->detail[0]              = (uintptr_t)arg_count;
+    exc->detail[1]              = (uintptr_t)expected_arg;
+
+    return exc;
+}
+
+
+static jml_obj_string_t *
+jml_error_implemented_render(jml_obj_exception_t *exc)
+{
+    char message[128];
+
+    int length = snprintf(message, sizeof(message), "Not implemented for %s.",
+        (const char*)exc->detail[0]);
+
+    return jml_obj_string_copy(message, length);
 }
 
 
 jml_obj_exception_t *
 jml_error_implemented(jml_value_t value)
 {
-    return jml_obj_exception_format(
-        "NotImplemented",
-        "Not implemented for %s.",
-        jml_value_stringify_type(value)
-    );
+    jml_obj_exception_t *exc    = jml_obj_exception_lazy(
+        "NotImplemented", jml_error_implemented_render);
+
+    exc->detail[0]              = (uintptr_t)jml_value_stringify_type(value);
+
+    return exc;
+}
+
+
+static jml_obj_string_t *
+jml_error_types_render(jml_obj_exception_t *exc)
+{
+    bool   mult                 = exc->detail[0] & 1;
+    size_t count                = exc->detail[0] >> 1;
+
+    char   message[256];
+    char  *head                 = message;
+    char  *end                  = message + sizeof(message);
+
+    head += snprintf(head, end - head, "Expected arguments of <type %s>",
+        (const char*)exc->detail[1]);
+
+    for (size_t i = 1; i < count && head < end; ++i)
+        head += snprintf(head, end - head, mult ? " or <type %s>" : " and <type %s>",
+            (const char*)exc->detail[i + 1]);
+
+    if (head < end)
+        head += snprintf(head, end - head, ".");
+
+    return jml_obj_string_copy(message, head < end ? (size_t)(head - message) : sizeof(message) - 1);
 }
 
 
@@ -43,6 +99,19 @@ jml_error_types(bool mult, int arg_count, ...)
     va_list types;
     va_start(types, arg_count);
 
+    if (arg_count <= 3) {
+        jml_obj_exception_t *exc = jml_obj_exception_lazy(
+            "DiffTypes", jml_error_types_render);
+
+        exc->detail[0]           = (uintptr_t)arg_count << 1 | mult;
+
+        for (int i = 0; i < arg_count; ++i)
+            exc->detail[i + 1]   = (uintptr_t)va_arg(types, char*);
+
+        va_end(types);
+        return exc;
+    }
+
     size_t size                 = (arg_count + 1) * 32;
     size_t dest_size            = 0;
     char  *message              = jml_realloc(NULL, size);
@@ -74,10 +143,98 @@ jml_error_types(bool mult, int arg_count, ...)
 }
 
 
+static jml_obj_string_t *
+jml_error_value_render(jml_obj_exception_t *exc)
+{
+    char message[128];
+
+    int length = snprintf(message, sizeof(message), "Invalid '%s'.",
+        (const char*)exc->detail[0]);
+
+    return jml_obj_string_copy(message,
+        length < (int)sizeof(message) ? (size_t)length : sizeof(message) - 1);
+}
+
+
 jml_obj_exception_t *
 jml_error_value(const char *value)
 {
-    return jml_obj_exception_format(
-        "WrongValue", "Invalid '%s'.", value
-    );
+    jml_obj_exception_t *exc    = jml_obj_exception_lazy(
+        "WrongValue", jml_error_value_render);
+
+    exc->detail[0]              = (uintptr_t)value;
+
+    return exc;
+}
+
+
+static size_t
+jml_error_params_names(char *head, uint16_t params, const char *sep)
+{
+    static const char *names[] = {
+        "number", "bool", "none", "string", "array", "buffer",
+        "map", "class", "instance", "fn", "coroutine"
+    };
+
+    char *start                 = head;
+    bool  first                 = true;
+
+    if (params == JML_PARAM_ANY)
+        return sprintf(head, "any");
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (!(params & (1 << i)))
+            continue;
+
+        head += sprintf(head, first ? "%s" : sep, names[i]);
+        first = false;
+    }
+
+    return head - start;
+}
+
+
+static jml_obj_string_t *
+jml_error_params_render(jml_obj_exception_t *exc)
+{
+    uint16_t params             = (uint16_t)exc->detail[0];
+    int      arity              = (int)(exc->detail[0] >> 16);
+    int      index              = (int)exc->detail[1];
+    char     message[1024];
+    char    *head               = message;
+
+    head += sprintf(head, "Expected argument '%d' of <type ", index);
+    head += jml_error_params_names(head, params, "> or <type %s");
+    head += sprintf(head, "> in (");
+
+    /*the checked signature, two params per detail slot*/
+    for (int i = 0; i < arity && i < JML_PARAM_MAX; ++i) {
+        uint16_t param          = (uint16_t)(exc->detail[2 + i / 2] >> (i % 2 * 16));
+
+        if (i > 0)
+            head += sprintf(head, ", ");
+
+        head += jml_error_params_names(head, param, "|%s");
+    }
+
+    if (arity > JML_PARAM_MAX)
+        head += sprintf(head, ", ...");
+
+    head += sprintf(head, ").");
+    return jml_obj_string_copy(message, head - message);
+}
+
+
+jml_obj_exception_t *
+jml_error_params(const uint16_t *params, int arity, int index)
+{
+    jml_obj_exception_t *exc    = jml_obj_exception_lazy(
+        "DiffTypes", jml_error_params_render);
+
+    exc->detail[0]              = (uintptr_t)params[index] | (uintptr_t)arity << 16;
+    exc->detail[1]              = (uintptr_t)index + 1;
+    exc->detail[2]              = (uintptr_t)params[0] | (uintptr_t)params[1] << 16;
+    exc->detail[3]              = (uintptr_t)params[2] | (uintptr_t)params[3] << 16;
+
+    return exc;
 }
@@ -0,0 +1,381 @@
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+
+#include <jml/jml_format.h>
+#include <jml/jml_repr.h>
+#include <jml/jml_string.h>
+
+#define JML_VM_INTERNAL
+#include <jml/jml_vm.h>
+
+
+/*
+ * syntax of a replacement field is
+ * {[:[[fill]align][0][width][.precision]]}
+ * and the braces are escaped by doubling them
+ */
+static jml_obj_exception_t *
+jml_format_spec(const char *spec, size_t length,
+    jml_format_segment_t *segment)
+{
+    size_t i                        = 0;
+
+    segment->fill                   = ' ';
+    segment->align                  = 0;
+    segment->width                  = 0;
+    segment->precision              = -1;
+
+    if (length == 0)
+        return NULL;
+
+    if (spec[i++] != ':')
+        goto err;
+
+    if (i + 1 < length && (spec[i + 1] == '<'
+        || spec[i + 1] == '>' || spec[i + 1] == '^')) {
+
+        segment->fill               = spec[i];
+        segment->align              = spec[i + 1];
+        i                          += 2;
+
+    } else if (i < length && (spec[i] == '<'
+        || spec[i] == '>' || spec[i] == '^'))
+        segment->align              = spec[i++];
+
+    /*a leading zero pads with zeros*/
+    if (i < length && spec[i] == '0' && segment->align == 0) {
+        segment->fill               = '0';
+        segment->align              = '>';
+    }
+
+    for (; i < length && jml_is_digit(spec[i]); ++i) {
+        segment->width              = segment->width * 10 + (spec[i] - '0');
+
+        if (segment->width > UINT16_MAX)
+            goto err;
+    }
+
+    if (i < length && spec[i] == '.') {
+        if (++i == length || !jml_is_digit(spec[i]))
+            goto err;
+
+        segment->precision          = 0;
+
+        for (; i < length && jml_is_digit(spec[i]); ++i) {
+            segment->precision      = segment->precision * 10 + (spec[i] - '0');
+
+            if (segment->precision > UINT8_MAX)
+                goto err;
+        }
+    }
+
+    if (i == length)
+        return NULL;
+
+err:
+    return jml_obj_exception_format(
+        "FormatErr",
+        "Invalid format specifier '%.*s'.",
+        (int32_t)length, spec
+    );
+}
+
+
+static jml_format_t *
+jml_format_parse(jml_obj_string_t *string, jml_obj_exception_t **exc)
+{
+    const char         *chars       = string->chars;
+    size_t              length      = string->length;
+    uint32_t            braces      = 0;
+
+    for (size_t i = 0; i < length; ++i)
+        braces                     += chars[i] == '{' || chars[i] == '}';
+
+    jml_format_t       *format      = jml_alloc(sizeof(jml_format_t)
+        + (braces + 1) * sizeof(jml_format_segment_t));
+
+    jml_format_segment_t *segment   = format->segments;
+    size_t              start       = 0;
+    size_t              i           = 0;
+
+    while (i < length) {
+        char c                      = chars[i];
+
+        if (c != '{' && c != '}') {
+            ++i;
+            continue;
+        }
+
+        /*an escaped brace ends the literal run right after itself*/
+        if (i + 1 < length && chars[i + 1] == c) {
+            segment->offset         = start;
+            segment->length         = i + 1 - start;
+            segment->field          = false;
+            ++segment;
+
+            start                   = i += 2;
+            continue;
+        }
+
+        if (c == '}') {
+            *exc = jml_obj_exception_new(
+                "FormatErr", "Single '}' in format string."
+            );
+            goto err;
+        }
+
+        const char *close           = memchr(chars + i, '}', length - i);
+
+        if (close == NULL) {
+            *exc = jml_obj_exception_new(
+                "FormatErr", "Single '{' in format string."
+            );
+            goto err;
+        }
+
+        segment->offset             = start;
+        segment->length             = i - start;
+        segment->field              = true;
+
+        if ((*exc = jml_format_spec(chars + i + 1,
+            close - chars - i - 1, segment)) != NULL)
+            goto err;
+
+        ++segment;
+        ++format->fields;
+
+        start = i                   = close - chars + 1;
+    }
+
+    segment->offset                 = start;
+    segment->length                 = length - start;
+    segment->field                  = false;
+
+    format->count                   = segment - format->segments + 1;
+    return format;
+
+err:
+    jml_free(format);
+    return NULL;
+}
+
+
+/*templates are parsed once, then found through the string*/
+static jml_format_t *
+jml_format_cached(jml_obj_string_t *string, bool *owned,
+    jml_obj_exception_t **exc)
+{
+    *owned                          = false;
+
+    if (string->format != 0)
+        return vm->formats[string->format - 1];
+
+    jml_format_t *format            = jml_format_parse(string, exc);
+
+    if (format == NULL)
+        return NULL;
+
+    for (uint32_t i = 0; i < FORMAT_CACHE; ++i) {
+        uint32_t slot               = (vm->format_hint + i) % FORMAT_CACHE;
+
+        if (vm->formats[slot] == NULL) {
+            vm->formats[slot]       = format;
+            vm->format_hint         = slot + 1;
+            string->format          = slot + 1;
+            return format;
+        }
+    }
+
+    /*the cache is full, the template lives for this call only*/
+    *owned                          = true;
+    return format;
+}
+
+
+static void
+jml_format_value(jml_strbuf_t *buf, jml_value_t value,
+    jml_format_segment_t *segment)
+{
+    char                number[64];
+    char               *temp        = NULL;
+    const char         *text;
+    size_t              length;
+    char                align       = segment->align;
+
+    if (IS_STRING(value)) {
+        text                        = AS_CSTRING(value);
+        length                      = AS_STRING(value)->length;
+
+        /*precision truncates strings to a number of characters*/
+        if (segment->precision >= 0) {
+            size_t bytes            = 0;
+
+            for (int32_t i = 0; i < segment->precision && bytes < length; ++i) {
+                uint8_t size        = jml_string_charbytes(text, bytes);
+                bytes              += size == 0 ? 1 : size;
+            }
+
+            length                  = bytes < length ? bytes : length;
+        }
+
+    } else if (IS_NUM(value)) {
+        int size                    = segment->precision >= 0
+            ? snprintf(NULL, 0, "%.*f", segment->precision, AS_NUM(value))
+            : snprintf(number, sizeof(number), "%.*g", DBL_DIG, AS_NUM(value));
+
+        if ((size_t)size >= sizeof(number)) {
+            temp                    = jml_alloc(size + 1);
+            snprintf(temp, size + 1, "%.*f", segment->precision, AS_NUM(value));
+            text                    = temp;
+        } else {
+            if (segment->precision >= 0)
+                snprintf(number, sizeof(number), "%.*f",
+                    segment->precision, AS_NUM(value));
+
+            text                    = number;
+        }
+
+        length                      = size;
+
+        if (align == 0)
+            align                   = '>';
+
+    } else if (IS_BOOL(value)) {
+        text                        = AS_BOOL(value) ? "true" : "false";
+        length                      = strlen(text);
+
+    } else if (IS_NONE(value)) {
+        text                        = "none";
+        length                      = 4;
+
+    } else {
+        /*other values are written in place and padded afterwards*/
+        size_t          start       = buf->length;
+        jml_value_write(buf, value);
+
+        if (segment->width <= 0)
+            return;
+
+        length                      = buf->length - start;
+        size_t          chars       = jml_string_len(buf->chars + start, length);
+
+        if ((size_t)segment->width <= chars)
+            return;
+
+        size_t          padding     = segment->width - chars;
+        size_t          before      = align == '>' ? padding
+            : align == '^' ? padding / 2 : 0;
+
+        jml_strbuf_reserve(buf, padding);
+
+        if (before > 0) {
+            memmove(buf->chars + start + before, buf->chars + start, length);
+            memset(buf->chars + start, segment->fill, before);
+            buf->length            += before;
+            buf->chars[buf->length] = '\0';
+        }
+
+        if (padding > before)
+            jml_strbuf_fill(buf, segment->fill, padding - before);
+
+        return;
+    }
+
+    size_t              chars       = segment->width > 0
+        ? jml_string_len(text, length) : 0;
+
+    size_t              padding     = (size_t)segment->width > chars
+        ? segment->width - chars : 0;
+
+    size_t              before      = align == '>' ? padding
+        : align == '^' ? padding / 2 : 0;
+
+    jml_strbuf_reserve(buf, length + padding);
+
+    if (before > 0)
+        jml_strbuf_fill(buf, segment->fill, before);
+
+    jml_strbuf_append(buf, text, length);
+
+    if (padding > before)
+        jml_strbuf_fill(buf, segment->fill, padding - before);
+
+    if (temp != NULL)
+        jml_free(temp);
+}
+
+
+bool
+jml_format_write(jml_strbuf_t *buf, jml_obj_string_t *format,
+    int arg_count, jml_value_t *args, jml_obj_exception_t **exc)
+{
+    bool                owned;
+    jml_format_t       *template    = jml_format_cached(format, &owned, exc);
+
+    if (template == NULL)
+        return false;
+
+    if (template->fields != (uint32_t)arg_count) {
+        *exc = jml_obj_exception_format(
+            "FormatErr",
+            "Expected '%d' format arguments but got '%d'.",
+            template->fields, arg_count
+        );
+
+        if (owned)
+            jml_free(template);
+
+        return false;
+    }
+
+    int                 arg         = 0;
+
+    for (uint32_t i = 0; i < template->count; ++i) {
+        jml_format_segment_t *segment = &template->segments[i];
+
+        jml_strbuf_append(buf,
+            format->chars + segment->offset, segment->length);
+
+        if (segment->field)
+            jml_format_value(buf, args[arg++], segment);
+    }
+
+    if (owned)
+        jml_free(template);
+
+    return true;
+}
+
+
+jml_value_t
+jml_format(jml_obj_string_t *format,
+    int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = NULL;
+    jml_strbuf_t        buf;
+
+    jml_strbuf_init(&buf, format->length + arg_count * 16);
+
+    if (!jml_format_write(&buf, format, arg_count, args, &exc)) {
+        jml_strbuf_free(&buf);
+        return OBJ_VAL(exc);
+    }
+
+    return OBJ_VAL(
+        jml_obj_string_take(buf.chars, buf.length)
+    );
+}
+
+
+void
+jml_format_release(jml_obj_string_t *string)
+{
+    if (string->format == 0)
+        return;
+
+    jml_free(vm->formats[string->format - 1]);
+
+    vm->formats[string->format - 1] = NULL;
+    string->format                  = 0;
+}
@@ -6,6 +6,7 @@
 #include <jml/jml_gc.h>
 #include <jml/jml_module.h>
 #include <jml/jml_compiler.h>
+#include <jml/jml_format.h>
 
 #define JML_VM_INTERNAL
 #include <jml/jml_vm.h>
@@ -17,6 +18,23 @@
 #endif
 
 
+/*
+ * the sweep already removed dead strings,
+ * only the shards it touched may need to shrink
+ */
+static void
+jml_gc_shrink_strings(void)
+{
+    uint64_t dirty              = vm->strings_dirty;
+    vm->strings_dirty           = 0;
+
+    for (int i = 0; i < STRINGS_SHARDS; ++i) {
+        if (dirty & ((uint64_t)1 << i))
+            jml_hashmap_shrink(&vm->strings[i]);
+    }
+}
+
+
 void *
 jml_reallocate(void *ptr,
     size_t old_size, size_t new_size)
@@ -30,6 +48,10 @@ jml_reallocate(void *ptr,
         if (vm->allocated > vm->next_gc)
             jml_gc_collect();
 #endif
+
+        /*the shrink allocates, so it runs once the collection is over*/
+        if (vm->strings_dirty != 0)
+            jml_gc_shrink_strings();
     }
 
 #ifdef JML_TRACE_MEM
@@ -103,23 +125,30 @@ jml_free(void *ptr)
 void
 jml_gc_exempt_push(jml_value_t value)
 {
-    *vm->exempt_top = value;
-    vm->exempt_top++;
+    /*grows like the gray stack, as callbacks can nest*/
+    if (vm->exempt_capacity < vm->exempt_count + 1) {
+        vm->exempt_capacity = GROW_CAPACITY(vm->exempt_capacity);
+        vm->exempt_stack = (jml_value_t*)jml_realloc(vm->exempt_stack,
+            sizeof(jml_value_t) * vm->exempt_capacity);
+    }
+    vm->exempt_stack[vm->exempt_count++] = value;
 }
 
 
 jml_value_t
 jml_gc_exempt_pop(void)
 {
-    vm->exempt_top--;
-    return *vm->exempt_top;
+    if (vm->exempt_count == 0)
+        return NONE_VAL;
+
+    return vm->exempt_stack[--vm->exempt_count];
 }
 
 
 jml_value_t
 jml_gc_exempt_peek(int distance)
 {
-    return vm->exempt_top[-1 - distance];
+    return vm->exempt_stack[vm->exempt_count - 1 - distance];
 }
 
 
@@ -150,6 +179,8 @@ jml_gc_mark_roots(void)
     jml_gc_mark_obj((jml_obj_t*)vm->get_string);
     jml_gc_mark_obj((jml_obj_t*)vm->set_string);
     jml_gc_mark_obj((jml_obj_t*)vm->size_string);
+    jml_gc_mark_obj((jml_obj_t*)vm->iter_string);
+    jml_gc_mark_obj((jml_obj_t*)vm->next_string);
     jml_gc_mark_obj((jml_obj_t*)vm->print_string);
     jml_gc_mark_obj((jml_obj_t*)vm->str_string);
     jml_gc_mark_obj((jml_obj_t*)vm->inherit_string);
@@ -157,6 +188,8 @@ jml_gc_mark_roots(void)
     jml_gc_mark_obj((jml_obj_t*)vm->running);
     jml_gc_mark_obj((jml_obj_t*)vm->current);
     jml_gc_mark_obj((jml_obj_t*)vm->external);
+    jml_gc_mark_obj((jml_obj_t*)vm->callback);
+    jml_gc_mark_obj((jml_obj_t*)vm->raised);
 
     for (jml_compiler_t **compiler = vm->compilers;
         compiler < vm->compiler_top; ++compiler) {
@@ -165,7 +198,7 @@ jml_gc_mark_roots(void)
     }
 
     for (jml_value_t *exempt = vm->exempt_stack;
-        exempt < vm->exempt_top; exempt++) {
+        exempt < vm->exempt_stack + vm->exempt_count; exempt++) {
 
         jml_gc_mark_value(*exempt);
     }
@@ -228,6 +261,7 @@ jml_gc_free_object(jml_obj_t *object)
     switch (object->type) {
         case OBJ_STRING: {
             jml_obj_string_t *string = (jml_obj_string_t*)object;
+            jml_format_release(string);
             FREE_ARRAY(char, string->chars, string->length + 1);
             FREE(jml_obj_string_t, object);
             break;
@@ -239,6 +273,16 @@ jml_gc_free_object(jml_obj_t *object)
             break;
         }
 
+        case OBJ_BUFFER: {
+            jml_obj_buffer_t *buffer = (jml_obj_buffer_t*)object;
+            if (buffer->release != NULL)
+                buffer->release(buffer->bytes, buffer->capacity);
+            else if (buffer->owner == NULL)
+                FREE_ARRAY(uint8_t, buffer->bytes, buffer->capacity);
+            FREE(jml_obj_buffer_t, object);
+            break;
+        }
+
         case OBJ_MAP: {
             jml_obj_map_t *map = (jml_obj_map_t*)object;
             jml_hashmap_free(&map->hashmap);
@@ -283,6 +327,7 @@ jml_gc_free_object(jml_obj_t *object)
 
             instance->extra = NULL;
             jml_hashmap_free(&instance->fields);
+            jml_hashmap_free(&instance->methods);
             FREE(jml_obj_instance_t, object);
             break;
         }
@@ -302,6 +347,7 @@ jml_gc_free_object(jml_obj_t *object)
         case OBJ_CLOSURE: {
             jml_obj_closure_t *closure = (jml_obj_closure_t*)object;
             FREE_ARRAY(jml_obj_upvalue_t*, closure->upvalues, closure->upvalue_count);
+            FREE_ARRAY(jml_obj_upvalue_t, closure->copies, closure->copy_count);
             FREE(jml_obj_closure_t, object);
             break;
         }
@@ -313,8 +359,7 @@ jml_gc_free_object(jml_obj_t *object)
 
         case OBJ_COROUTINE: {
             jml_obj_coroutine_t *coro = (jml_obj_coroutine_t*)object;
-            FREE_ARRAY(jml_call_frame_t, coro->frames, coro->frame_capacity);
-            FREE_ARRAY(jml_value_t, coro->stack, coro->stack_capacity);
+            jml_obj_coroutine_free(coro);
             FREE(jml_obj_coroutine_t, object);
             break;
         }
@@ -348,6 +393,7 @@ jml_gc_free_objs(void)
 
     jml_gc_free_object((jml_obj_t*)vm->free_string);
     jml_free(vm->gray_stack);
+    jml_free(vm->exempt_stack);
 }
 
 
@@ -372,6 +418,15 @@ jml_gc_sweep(void)
             else
                 vm->objects      = object;
 
+            if (unreached->type == OBJ_STRING) {
+                uint32_t shard   = STRINGS_SHARD(
+                    ((jml_obj_string_t*)unreached)->hash);
+
+                jml_hashmap_del(&vm->strings[shard],
+                    (jml_obj_string_t*)unreached);
+                vm->strings_dirty |= (uint64_t)1 << shard;
+            }
+
             jml_gc_free_object(unreached);
         }
     }
@@ -396,6 +451,11 @@ jml_gc_blacken_obj(jml_obj_t *object)
             break;
         }
 
+        case OBJ_BUFFER: {
+            jml_gc_mark_obj((jml_obj_t*)((jml_obj_buffer_t*)object)->owner);
+            break;
+        }
+
         case OBJ_MAP: {
             jml_hashmap_mark(&((jml_obj_map_t*)object)->hashmap);
             break;
@@ -412,6 +472,7 @@ jml_gc_blacken_obj(jml_obj_t *object)
             jml_obj_instance_t *instance = (jml_obj_instance_t*)object;
             jml_gc_mark_obj((jml_obj_t*)instance->klass);
             jml_hashmap_mark(&instance->fields);
+            jml_hashmap_mark(&instance->methods);
             break;
         }
 
@@ -434,7 +495,14 @@ jml_gc_blacken_obj(jml_obj_t *object)
             jml_obj_closure_t *closure = (jml_obj_closure_t*)object;
             jml_gc_mark_obj((jml_obj_t*)closure->function);
             for (int i = 0; i < closure->upvalue_count; ++i) {
-                jml_gc_mark_obj((jml_obj_t*)closure->upvalues[i]);
+                jml_obj_upvalue_t *upvalue = closure->upvalues[i];
+
+                /*copies live inside the closure*/
+                if (closure->copy_count > 0 && upvalue >= closure->copies
+                    && upvalue < closure->copies + closure->copy_count)
+                    jml_gc_mark_value(upvalue->closed);
+                else
+                    jml_gc_mark_obj((jml_obj_t*)upvalue);
             }
             break;
         }
@@ -443,6 +511,7 @@ jml_gc_blacken_obj(jml_obj_t *object)
             jml_obj_function_t *function = (jml_obj_function_t*)object;
             jml_gc_mark_obj((jml_obj_t*)function->name);
             jml_gc_mark_obj((jml_obj_t*)function->klass_name);
+            jml_gc_mark_obj((jml_obj_t*)function->closure);
             jml_gc_mark_array(&function->bytecode.constants);
             break;
         }
@@ -459,6 +528,14 @@ jml_gc_blacken_obj(jml_obj_t *object)
                 slot < coro->stack_top; ++slot)
                 jml_gc_mark_value(*slot);
 
+            for (jml_stack_segment_t *segment = coro->segment->prev;
+                segment != NULL; segment = segment->prev) {
+
+                for (jml_value_t *slot = segment->values;
+                    slot < segment->top; ++slot)
+                    jml_gc_mark_value(*slot);
+            }
+
             for (uint32_t i = 0; i < coro->frame_count; ++i)
                 jml_gc_mark_obj((jml_obj_t*)coro->frames[i].closure);
 
@@ -481,6 +558,7 @@ jml_gc_blacken_obj(jml_obj_t *object)
             jml_obj_exception_t *exc = (jml_obj_exception_t*)object;
             jml_gc_mark_obj((jml_obj_t*)exc->name);
             jml_gc_mark_obj((jml_obj_t*)exc->message);
+            jml_gc_mark_obj((jml_obj_t*)exc->module);
             break;
         }
     }
@@ -514,7 +592,6 @@ jml_gc_collect(void)
 
     jml_gc_mark_roots();
     jml_gc_trace_refs();
-    jml_hashmap_remove_white(&vm->strings);
     jml_gc_sweep();
 
     vm->next_gc = vm->allocated * GC_HEAP_GROW_FACTOR;
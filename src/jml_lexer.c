@@ -182,7 +182,15 @@ jml_identifier_check(jml_lexer_t *lexer)
             break;
 
         case 'b': return jml_keyword_match(1, 4, "reak", TOKEN_BREAK, lexer);
-        case 'c': return jml_keyword_match(1, 4, "lass", TOKEN_CLASS, lexer);
+        case 'c':
+            if (lexer->current - lexer->start > 1) {
+                switch (lexer->start[1]) {
+                    case 'a': return jml_keyword_match(2, 3, "tch", TOKEN_CATCH, lexer);
+                    case 'l': return jml_keyword_match(2, 3, "ass", TOKEN_CLASS, lexer);
+                }
+            }
+            break;
+
         case 'e': return jml_keyword_match(1, 3, "lse", TOKEN_ELSE, lexer);
 
         case 'f':
@@ -552,6 +560,7 @@ jml_token_type_print(jml_token_type type)
         case PRINT_TOKEN(TOKEN_ASYNC);
         case PRINT_TOKEN(TOKEN_AWAIT);
         case PRINT_TOKEN(TOKEN_TRY);
+        case PRINT_TOKEN(TOKEN_CATCH);
         case PRINT_TOKEN(TOKEN_SPREAD);
         case PRINT_TOKEN(TOKEN_AND);
         case PRINT_TOKEN(TOKEN_NOT);
@@ -299,6 +299,121 @@ jml_module_get_raw(jml_obj_module_t *module,
 }
 
 
+static void
+jml_module_signature_apply(jml_obj_cfunction_t *cfunction,
+    jml_module_signature *signature)
+{
+    cfunction->flags                = signature->flags;
+    cfunction->arity                = signature->arity;
+
+    memcpy(cfunction->params, signature->params, sizeof(signature->params));
+}
+
+
+#ifndef JML_LAZY_IMPORT
+static void
+jml_module_sign(jml_obj_module_t *module,
+    jml_module_signature *signatures)
+{
+    jml_module_signature *current;
+    if ((current = signatures) != NULL) {
+        while (current->name != NULL) {
+            jml_value_t *cfunction;
+
+            if (jml_hashmap_get(&module->globals,
+                AS_STRING(jml_string_intern(current->name)), &cfunction)
+                && IS_CFUNCTION(*cfunction))
+                jml_module_signature_apply(AS_CFUNCTION(*cfunction), current);
+
+            ++current;
+        }
+    }
+}
+#endif
+
+
+static jml_obj_cfunction_t *
+jml_module_bind(jml_obj_module_t *module,
+    jml_obj_string_t *name, jml_cfunction function)
+{
+    jml_gc_exempt_push(OBJ_VAL(name));
+
+    jml_obj_cfunction_t *cfunction  = jml_obj_cfunction_new(
+        name, function, module);
+    jml_gc_exempt_push(OBJ_VAL(cfunction));
+
+    jml_module_signature *current   = (jml_module_signature*)SHARED_SYM(
+        module->handle, "module_signatures");
+
+    if (current != NULL) {
+        while (current->name != NULL) {
+            if (strcmp(current->name, name->chars) == 0) {
+                jml_module_signature_apply(cfunction, current);
+                break;
+            }
+
+            ++current;
+        }
+    }
+
+    jml_hashmap_set(&module->globals, name, OBJ_VAL(cfunction));
+
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+    return cfunction;
+}
+
+
+jml_obj_cfunction_t *
+jml_module_lazy_bind(jml_obj_module_t *module,
+    jml_obj_string_t *name)
+{
+    if (module->handle == NULL)
+        return NULL;
+
+    jml_module_function *current    = (jml_module_function*)SHARED_SYM(
+        module->handle, "module_table");
+
+    if (current != NULL) {
+        while (current->name != NULL
+            && current->function != NULL) {
+
+            if (strcmp(current->name, name->chars) == 0)
+                return jml_module_bind(module, name, current->function);
+
+            ++current;
+        }
+    }
+
+    return NULL;
+}
+
+
+void
+jml_module_lazy_bind_all(jml_obj_module_t *module)
+{
+    if (module->handle == NULL)
+        return;
+
+    jml_module_function *current    = (jml_module_function*)SHARED_SYM(
+        module->handle, "module_table");
+
+    if (current != NULL) {
+        while (current->name != NULL
+            && current->function != NULL) {
+
+            jml_value_t  name       = jml_string_intern(current->name);
+            jml_value_t *value;
+
+            if (!jml_hashmap_get(&module->globals, AS_STRING(name), &value))
+                jml_module_bind(module, AS_STRING(name), current->function);
+
+            ++current;
+        }
+    }
+}
+
+
 void
 jml_module_register(jml_obj_module_t *module,
     jml_module_function *table)
@@ -380,6 +495,9 @@ jml_module_initialize(jml_obj_module_t *module)
             ++current;
         }
     }
+
+    jml_module_sign(module, (jml_module_signature*)SHARED_SYM(
+        module->handle, "module_signatures"));
 #endif
     return true;
 }
@@ -11,37 +11,55 @@
 #include <jml/jml_vm.h>
 
 
-void
-jml_value_print(jml_value_t value)
+static const char *
+jml_repr_buffer_type(jml_buffer_type type)
+{
+    switch (type) {
+        case BUFFER_I32:    return "i32";
+        case BUFFER_F64:    return "f64";
+        default:            return "u8";
+    }
+}
+
+
+static void jml_obj_write_mode(jml_strbuf_t *buf,
+    jml_value_t value, bool print);
+
+
+/*print quotes strings and calls __print instead of __str*/
+static void
+jml_value_write_mode(jml_strbuf_t *buf, jml_value_t value, bool print)
 {
 #ifdef JML_NAN_TAGGING
     if (IS_OBJ(value))
-        jml_obj_print(value);
+        jml_obj_write_mode(buf, value, print);
 
     else if (IS_NUM(value))
-        printf("%.*g", DBL_DIG, AS_NUM(value));
+        jml_strbuf_printf(buf, "%.*g", DBL_DIG, AS_NUM(value));
 
     else if (IS_BOOL(value))
-        printf(AS_BOOL(value) ? "true" : "false");
+        jml_strbuf_append(buf, AS_BOOL(value) ? "true" : "false",
+            AS_BOOL(value) ? 4 : 5);
 
     else if (IS_NONE(value))
-        printf("none");
+        jml_strbuf_append(buf, "none", 4);
 #else
     switch (value.type) {
         case VAL_BOOL:
-            printf(AS_BOOL(value) ? "true" : "false");
+            jml_strbuf_append(buf, AS_BOOL(value) ? "true" : "false",
+                AS_BOOL(value) ? 4 : 5);
             break;
 
         case VAL_NONE:
-            printf("none");
+            jml_strbuf_append(buf, "none", 4);
             break;
 
         case VAL_NUM:
-            printf("%.*g", DBL_DIG, AS_NUM(value));
+            jml_strbuf_printf(buf, "%.*g", DBL_DIG, AS_NUM(value));
             break;
 
         case VAL_OBJ:
-            jml_obj_print(value);
+            jml_obj_write_mode(buf, value, print);
             break;
     }
 #endif
@@ -49,542 +67,334 @@ jml_value_print(jml_value_t value)
 
 
 static void
-jml_obj_function_print(jml_obj_function_t *function,
-    const char *type)
+jml_obj_function_write(jml_strbuf_t *buf,
+    jml_obj_function_t *function, const char *type)
 {
-    printf("<%s ", type);
+    jml_strbuf_printf(buf, "<%s ", type);
 
     if (function->name == NULL) {
-        printf("__main>");
+        jml_strbuf_append(buf, "__main>", 7);
         return;
     }
 
     if (function->module != NULL)
-        printf("%.*s.", (int32_t)function->module->name->length,
+        jml_strbuf_printf(buf, "%.*s.", (int32_t)function->module->name->length,
             function->module->name->chars);
 
     if (function->klass_name != NULL)
-        printf("%.*s.", (int32_t)function->klass_name->length,
+        jml_strbuf_printf(buf, "%.*s.", (int32_t)function->klass_name->length,
             function->klass_name->chars);
 
-    printf("%.*s", (int32_t)function->name->length,
-        function->name->chars);
+    jml_strbuf_append(buf, function->name->chars, function->name->length);
 
     if (!function->variadic)
-        printf("/%d", function->arity);
+        jml_strbuf_printf(buf, "/%d", function->arity);
 
-    printf(">");
+    jml_strbuf_append(buf, ">", 1);
 }
 
 
 static void
-jml_obj_cfunction_print(jml_obj_cfunction_t *function,
-    const char *type)
+jml_obj_cfunction_write(jml_strbuf_t *buf,
+    jml_obj_cfunction_t *function, const char *type)
 {
-    printf("<%s", type);
+    jml_strbuf_printf(buf, "<%s", type);
 
     if (function->name == NULL) {
-        printf(">");
+        jml_strbuf_append(buf, ">", 1);
         return;
     }
 
-    printf(" ");
+    jml_strbuf_append(buf, " ", 1);
 
     if (function->module != NULL)
-        printf("%.*s.", (int32_t)function->module->name->length,
+        jml_strbuf_printf(buf, "%.*s.", (int32_t)function->module->name->length,
             function->module->name->chars);
 
     if (function->klass_name != NULL)
-        printf("%.*s.", (int32_t)function->klass_name->length,
+        jml_strbuf_printf(buf, "%.*s.", (int32_t)function->klass_name->length,
             function->klass_name->chars);
 
-    printf("%.*s>", (int32_t)function->name->length,
+    jml_strbuf_printf(buf, "%.*s>", (int32_t)function->name->length,
         function->name->chars);
 }
 
 
-void
-jml_obj_print(jml_value_t value)
+static void
+jml_obj_class_write(jml_strbuf_t *buf,
+    jml_obj_class_t *klass, const char *type)
+{
+    jml_strbuf_printf(buf, "<%s ", type);
+
+    if (klass->module != NULL)
+        jml_strbuf_printf(buf, "%.*s.", (int32_t)klass->module->name->length,
+            klass->module->name->chars);
+
+    jml_strbuf_printf(buf, "%.*s>", (int32_t)klass->name->length,
+        klass->name->chars);
+}
+
+
+static bool
+jml_obj_instance_hook(jml_strbuf_t *buf,
+    jml_obj_instance_t *instance, bool print)
+{
+    jml_obj_string_t *name          = print ? vm->print_string : vm->str_string;
+    jml_value_t      *method;
+
+    if (name == NULL
+        || !jml_hashmap_get(&instance->klass->statics, name, &method))
+        return false;
+
+    jml_value_t last                = NONE_VAL;
+
+    if (IS_CFUNCTION(*method)) {
+        jml_value_t args = OBJ_VAL(instance);
+        last = AS_CFUNCTION(*method)->function(1, &args);
+
+    } else if (IS_CLOSURE(*method)) {
+        /*the method is bound so that self is the instance*/
+        jml_gc_exempt_push(OBJ_VAL(jml_obj_coroutine_new(NULL)));
+        jml_gc_exempt_push(OBJ_VAL(
+            jml_obj_method_new(OBJ_VAL(instance), AS_CLOSURE(*method))
+        ));
+
+        bool success                = jml_vm_callback(
+            AS_COROUTINE(jml_gc_exempt_peek(1)),
+            jml_gc_exempt_peek(0), 0, NULL, &last
+        );
+
+        jml_gc_exempt_pop();
+        jml_gc_exempt_pop();
+
+        if (!success) {
+            /*nothing catches it here, so it is reported*/
+            if (IS_EXCEPTION(last))
+                jml_vm_report(AS_EXCEPTION(last));
+
+            if (print)
+                return true;
+
+            jml_vm_error(
+                "DiffTypes: Can't get string from instance of '%.*s'.",
+                (int32_t)instance->klass->name->length,
+                instance->klass->name->chars
+            );
+            return false;
+        }
+
+    } else
+        return false;
+
+    /*__print writes on its own*/
+    if (print)
+        return true;
+
+    jml_gc_exempt_push(last);
+    jml_value_write_mode(buf, last, false);
+    jml_gc_exempt_pop();
+
+    return true;
+}
+
+
+static void
+jml_obj_write_mode(jml_strbuf_t *buf, jml_value_t value, bool print)
 {
     switch (OBJ_TYPE(value)) {
         case OBJ_STRING: {
             jml_obj_string_t *string = AS_STRING(value);
-            printf("\"%.*s\"", (int32_t)string->length, string->chars);
+
+            if (print)
+                jml_strbuf_printf(buf, "\"%.*s\"",
+                    (int32_t)string->length, string->chars);
+            else
+                jml_strbuf_append(buf, string->chars, string->length);
             break;
         }
 
         case OBJ_ARRAY: {
-            printf("[");
-            jml_value_array_t array = AS_ARRAY(value)->values;
-            if (array.count <= 0) {
-                printf("]");
-                break;
-            }
+            jml_obj_array_t *array  = AS_ARRAY(value);
+            jml_strbuf_append(buf, "[", 1);
 
-            int item_count          = array.count - 1;
-            for (int i = 0; i < item_count; ++i) {
-                jml_value_print(array.values[i]);
-                printf(", ");
+            /*elements may run __str, which can grow the array*/
+            for (int i = 0; i < array->values.count; ++i) {
+                if (i > 0)
+                    jml_strbuf_append(buf, ", ", 2);
+
+                jml_value_write_mode(buf, array->values.values[i], print);
             }
 
-            jml_value_print(array.values[item_count]);
-            printf("]");
+            jml_strbuf_append(buf, "]", 1);
+            break;
+        }
+
+        case OBJ_BUFFER: {
+            jml_obj_buffer_t *buffer = AS_BUFFER(value);
+
+            if (buffer->type == BUFFER_U8)
+                jml_strbuf_printf(buf, "<buffer of %zu bytes>", buffer->length);
+            else
+                jml_strbuf_printf(buf, "<%s buffer of %zu elements>",
+                    jml_repr_buffer_type(buffer->type),
+                    jml_obj_buffer_count(buffer));
             break;
         }
 
         case OBJ_MAP: {
-            printf("{");
             jml_hashmap_t hashmap   = AS_MAP(value)->hashmap;
+            jml_strbuf_append(buf, "{", 1);
+
             if (hashmap.count <= 0) {
-                printf("}");
+                jml_strbuf_append(buf, "}", 1);
                 break;
             }
 
-            int item_count          = hashmap.count - 1;
+            int item_count          = hashmap.count;
             jml_hashmap_entry_t *entries = jml_hashmap_iterator(&hashmap);
 
             for (int i = 0; i < item_count; ++i) {
-                printf("\"%.*s\": ", (int32_t)entries[i].key->length,
-                    entries[i].key->chars);
-                jml_value_print(entries[i].value);
-                printf(", ");
-            }
+                if (i > 0)
+                    jml_strbuf_append(buf, ", ", 2);
 
-            printf("\"%.*s\": ",(int32_t) entries[item_count].key->length,
-                entries[item_count].key->chars);
-            jml_value_print(entries[item_count].value);
-            printf("}");
+                jml_strbuf_printf(buf, "\"%.*s\": ",
+                    (int32_t)entries[i].key->length, entries[i].key->chars);
+                jml_value_write_mode(buf, entries[i].value, print);
+            }
 
-            jml_realloc(entries, 0);
+            jml_strbuf_append(buf, "}", 1);
+            jml_free(entries);
             break;
         }
 
         case OBJ_MODULE: {
             jml_obj_module_t *module = AS_MODULE(value);
-            printf("<module %.*s>", (int32_t)module->name->length, module->name->chars);
+            jml_strbuf_printf(buf, "<module %.*s>",
+                (int32_t)module->name->length, module->name->chars);
             break;
         }
 
-        case OBJ_CLASS: {
-            jml_obj_class_t *klass  = AS_CLASS(value);
-            printf("<class ");
-
-            if (klass->module != NULL)
-                printf("%.*s.", (int32_t)klass->module->name->length,
-                    klass->module->name->chars);
-
-            printf("%.*s>", (int32_t)klass->name->length, klass->name->chars);
+        case OBJ_CLASS:
+            jml_obj_class_write(buf,
+                AS_CLASS(value), "class");
             break;
-        }
 
         case OBJ_INSTANCE: {
-            jml_obj_instance_t *instance    = AS_INSTANCE(value);
-
-            if (vm->print_string != NULL) {
-                jml_value_t *method;
-                if (jml_hashmap_get(&instance->klass->statics,
-                    vm->print_string, &method)) {
-
-                    if (IS_CFUNCTION(*method)) {
-                        jml_value_t args = OBJ_VAL(instance);
-                        AS_CFUNCTION(*method)->function(1, &args);
-                    } else {
-                        jml_obj_coroutine_t *coroutine = jml_obj_coroutine_new(NULL);
-                        jml_vm_call_value(coroutine, *method, 0);
-                        jml_vm_call_coroutine(coroutine, NULL);
-                    }
-                    return;
-                }
-            }
+            jml_obj_instance_t *instance = AS_INSTANCE(value);
 
-            printf("<instance of ");
-
-            if (instance->klass->module != NULL)
-                printf("%.*s.", (int32_t)instance->klass->module->name->length,
-                    instance->klass->module->name->chars);
-
-            printf("%.*s>", (int32_t)instance->klass->name->length,
-                instance->klass->name->chars);
+            if (!jml_obj_instance_hook(buf, instance, print))
+                jml_obj_class_write(buf,
+                    instance->klass, "instance of");
             break;
         }
 
         case OBJ_METHOD:
-            jml_obj_function_print(
+            jml_obj_function_write(buf,
                 AS_METHOD(value)->method->function, "fn");
             break;
 
         case OBJ_FUNCTION:
-            jml_obj_function_print(
+            jml_obj_function_write(buf,
                 AS_FUNCTION(value), "fn");
             break;
 
         case OBJ_CLOSURE:
-            jml_obj_function_print(
+            jml_obj_function_write(buf,
                 AS_CLOSURE(value)->function, "fn");
             break;
 
         case OBJ_UPVALUE:
-            printf("<upvalue>");
+            jml_strbuf_append(buf, "<upvalue>", 9);
             break;
 
-        case OBJ_COROUTINE:
-            jml_obj_function_print(
-                AS_COROUTINE(value)->frames[0].closure->function,
-                "coroutine"
-            );
+        case OBJ_COROUTINE: {
+            jml_obj_coroutine_t *coroutine = AS_COROUTINE(value);
+
+            if (coroutine->frame_count > 0)
+                jml_obj_function_write(buf,
+                    coroutine->frames[0].closure->function, "coroutine");
+            else
+                jml_strbuf_append(buf, "<coroutine>", 11);
             break;
+        }
 
         case OBJ_CFUNCTION:
-            jml_obj_cfunction_print(
+            jml_obj_cfunction_write(buf,
                 AS_CFUNCTION(value), "builtin fn");
             break;
 
         case OBJ_EXCEPTION: {
             jml_obj_exception_t *exc = AS_EXCEPTION(value);
-            printf("<exception ");
+            jml_strbuf_append(buf, "<exception ", 11);
 
             if (exc->module != NULL)
-                printf("%.*s.", (int32_t)exc->module->name->length,
+                jml_strbuf_printf(buf, "%.*s.", (int32_t)exc->module->name->length,
                     exc->module->name->chars);
 
-            printf("%.*s>", (int32_t)exc->name->length, exc->name->chars);
+            jml_strbuf_printf(buf, "%.*s>", (int32_t)exc->name->length,
+                exc->name->chars);
             break;
         }
     }
 }
 
 
-char *
-jml_value_stringify(jml_value_t value)
+void
+jml_value_write(jml_strbuf_t *buf, jml_value_t value)
 {
-#ifdef JML_NAN_TAGGING
-    if (IS_BOOL(value))
-        return jml_strdup(AS_BOOL(value) ? "true" : "false");
-
-    else if (IS_NONE(value))
-        return jml_strdup("none");
-
-    else if (IS_NUM(value)) {
-        char buffer[DBL_MANT_DIG];
-        sprintf(buffer, "%.*g", DBL_DIG, AS_NUM(value));
-        return jml_strdup(buffer);
-
-    } else if (IS_OBJ(value))
-        return jml_obj_stringify(value);
-#else
-    switch (value.type) {
-        case VAL_BOOL:
-            return jml_strdup(AS_BOOL(value) ? "true" : "false");
-
-        case VAL_NONE:
-            return jml_strdup("none");
-
-        case VAL_NUM: {
-            char buffer[DBL_MANT_DIG];
-            sprintf(buffer, "%.*g", DBL_DIG, AS_NUM(value));
-            return jml_strdup(buffer);
-        }
-
-        case VAL_OBJ:
-            return jml_obj_stringify(value);
-    }
-#endif
-    return NULL;
+    jml_value_write_mode(buf, value, false);
 }
 
 
-static char *
-jml_obj_function_stringify(jml_obj_function_t *function)
+void
+jml_obj_write(jml_strbuf_t *buf, jml_value_t value)
 {
-    if (function->name == NULL) {
-        return jml_strdup("<fn __main>");
-    }
-
-    size_t size = function->name->length * GC_HEAP_GROW_FACTOR;
-    char *fn = jml_realloc(NULL, size);
-
-    size_t pos = sprintf(fn, "<fn ");
-
-    if (function->module != NULL) {
-        REALLOC(char, fn, size, pos + function->module->name->length);
-        pos += sprintf(fn + pos, "%.*s.", (int32_t)function->module->name->length,
-            function->module->name->chars);
-    }
-
-    if (function->klass_name != NULL) {
-        REALLOC(char, fn, size, pos + function->klass_name->length);
-        pos += sprintf(fn + pos, "%.*s.", (int32_t)function->klass_name->length,
-            function->klass_name->chars);
-    }
-
-    REALLOC(char, fn, size, pos + function->name->length + 10);
-    pos += sprintf(fn + pos, "%.*s", (int32_t)function->name->length,
-        function->name->chars);
-
-    if (!function->variadic)
-        pos += sprintf(fn + pos, "/%d", function->arity);
-
-    pos += sprintf(fn + pos, ">");
-
-    return fn;
+    jml_obj_write_mode(buf, value, false);
 }
 
 
-static char *
-jml_obj_cfunction_stringify(jml_obj_cfunction_t *function)
+/*printing writes straight into the output buffer*/
+void
+jml_value_print(jml_value_t value)
 {
-    if (function->name == NULL) {
-        return jml_strdup("<builtin fn>");
-    }
-
-    size_t size = function->name->length * GC_HEAP_GROW_FACTOR;
-    char *cfn = jml_realloc(NULL, size);
-
-    size_t pos = sprintf(cfn, "<builtin fn ");
-
-    if (function->module != NULL) {
-        REALLOC(char, cfn, size, pos + function->module->name->length);
-        pos += sprintf(cfn + pos, "%.*s.", (int32_t)function->module->name->length,
-            function->module->name->chars);
-    }
+    size_t start                    = vm->output.length;
 
-    if (function->klass_name != NULL) {
-        REALLOC(char, cfn, size, pos + function->klass_name->length);
-        pos += sprintf(cfn + pos, "%.*s.", (int32_t)function->klass_name->length,
-            function->klass_name->chars);
-    }
-
-    REALLOC(char, cfn, size, pos + function->name->length + 3);
-    pos += sprintf(cfn + pos, "%.*s>", (int32_t)function->name->length,
-        function->name->chars);
-
-    return cfn;
+    jml_value_write_mode(&vm->output, value, true);
+    jml_output_commit(start);
 }
 
 
-#define CLASS_NAME(buffer, klass, size, pos)            \
-    do {                                                \
-        if (klass->module != NULL) {                    \
-            REALLOC(char, buffer, size,                 \
-                pos + klass->module->name->length);     \
-                                                        \
-            pos += sprintf(buffer + pos, "%.*s.",       \
-                (int32_t)klass->module->name->length,   \
-                klass->module->name->chars);            \
-        }                                               \
-        REALLOC(char, buffer, size,                     \
-            size + klass->name->length + 3);            \
-                                                        \
-        pos += sprintf(buffer + pos, "%.*s",            \
-            (int32_t)klass->name->length,               \
-            klass->name->chars);                        \
-    } while (false)
-
-
-static char *
-jml_obj_class_stringify(jml_obj_class_t *klass)
+void
+jml_obj_print(jml_value_t value)
 {
-    size_t size = klass->name->length * GC_HEAP_GROW_FACTOR;
-    char *buffer = jml_realloc(NULL, size);
-
-    size_t pos = sprintf(buffer, "<class ");
-    CLASS_NAME(buffer, klass, size, pos);
+    size_t start                    = vm->output.length;
 
-    return buffer;
+    jml_obj_write_mode(&vm->output, value, true);
+    jml_output_commit(start);
 }
 
 
-static char *
-jml_obj_instance_stringify(jml_obj_instance_t *instance)
+char *
+jml_value_stringify(jml_value_t value)
 {
-    if (vm->str_string != NULL) {
-        jml_value_t *method;
-        if (jml_hashmap_get(&instance->klass->statics,
-            vm->str_string, &method)) {
-
-            jml_value_t last                = NONE_VAL;
-
-            if (IS_CFUNCTION(*method)) {
-                jml_value_t args = OBJ_VAL(instance);
-                last = AS_CFUNCTION(*method)->function(1, &args);
-                return jml_value_stringify(last);
+    jml_strbuf_t buf;
 
-            } else {
-                jml_obj_coroutine_t *coroutine  = jml_obj_coroutine_new(NULL);
+    jml_strbuf_init(&buf, 32);
+    jml_value_write(&buf, value);
 
-                if (jml_vm_call_value(coroutine, *method, 0) &&
-                    jml_vm_call_coroutine(coroutine, &last) == INTERPRET_OK)
-                    return jml_value_stringify(last);
-            }
-
-            jml_vm_error(
-                "DiffTypes: Can't get size from instance of '%.*s'.",
-                (int32_t)instance->klass->name->length,
-                instance->klass->name->chars
-            );
-        }
-    }
-
-    size_t size = instance->klass->name->length * GC_HEAP_GROW_FACTOR;
-    char *buffer = jml_realloc(NULL, size);
-
-    size_t pos = sprintf(buffer, "<instance of ");
-    CLASS_NAME(buffer, instance->klass, size, pos);
-
-    return buffer;
+    return buf.chars;
 }
 
 
 char *
 jml_obj_stringify(jml_value_t value)
 {
-    switch (OBJ_TYPE(value)) {
-        case OBJ_STRING: {
-            size_t length = AS_STRING(value)->length + 1;
-            char *dest = jml_realloc(NULL, length);
-
-            if (!dest)
-                return NULL;
-
-            return memcpy(dest, AS_CSTRING(value), length);
-        }
-
-        case OBJ_ARRAY: {
-            jml_value_array_t array = AS_ARRAY(value)->values;
-
-            if (array.count <= 0)
-                return jml_strdup("[]");
-
-            size_t size = array.count * 34 + 3;
-            char *buffer = jml_realloc(NULL, size);
-            char *ptr = buffer;
-            *ptr++ = '[';
-
-            int item_count          = array.count - 1;
-            for (int i = 0; i < item_count; ++i) {
-                char *temp = jml_value_stringify(array.values[i]);
-                REALLOC(char, buffer, size, (ptr - buffer) + strlen(temp));
-                ptr += sprintf(ptr, "%s, ", temp);
-                jml_free(temp);
-            }
-
-            char *temp = jml_value_stringify(array.values[item_count]);
-            REALLOC(char, buffer, size, (ptr - buffer) + strlen(temp));
-            ptr += sprintf(ptr, "%s", temp);
-            jml_free(temp);
-
-            *ptr++ = ']';
-            *ptr = 0;
+    jml_strbuf_t buf;
 
-            return buffer;
-        }
-
-        case OBJ_MAP: {
-            jml_hashmap_t hashmap   = AS_MAP(value)->hashmap;
-
-            if (hashmap.count <= 0)
-                return jml_strdup("{}");
-
-            size_t size = hashmap.count * 38 + 3;
-            char *buffer = jml_realloc(NULL, size);
-            char *ptr = buffer;
-            *ptr++ = '{';
-
-            int item_count          = hashmap.count - 1;
-            jml_hashmap_entry_t *entries = jml_hashmap_iterator(&hashmap);
-
-            for (int i = 0; i < item_count; ++i) {
-                char *temp = jml_value_stringify(entries[i].value);
-                REALLOC(char, buffer, size,
-                    (ptr - buffer) + strlen(temp) + entries[i].key->length + 1);
-
-                ptr += sprintf(ptr, "\"%.*s\": %s, ", (int32_t)entries[i].key->length,
-                    entries[i].key->chars, temp);
-                jml_free(temp);
-            }
-
-            char *temp = jml_value_stringify(entries[item_count].value);
-            REALLOC(char, buffer, size,
-                (ptr - buffer) + strlen(temp) + entries[item_count].key->length + 2);
-
-            ptr += sprintf(ptr, "\"%.*s\": %s", (int32_t)entries[item_count].key->length,
-                entries[item_count].key->chars, temp);
-            jml_free(temp);
-            jml_free(entries);
-
-            *ptr++ = '}';
-            *ptr = 0;
-
-            return buffer;
-        }
-
-        case OBJ_MODULE: {
-            jml_obj_module_t *module = AS_MODULE(value);
-            char *buffer = jml_alloc(module->name->length + 16);
-
-            sprintf(buffer, "<module %.*s>",
-                (int32_t)module->name->length,
-                module->name->chars
-            );
-            return buffer;
-        }
-
-        case OBJ_CLASS:
-            return jml_obj_class_stringify(
-                AS_CLASS(value));
-
-        case OBJ_INSTANCE:
-            return jml_obj_instance_stringify(
-                AS_INSTANCE(value));
-
-        case OBJ_METHOD:
-            return jml_obj_function_stringify(
-                AS_METHOD(value)->method->function);
-
-        case OBJ_FUNCTION:
-            return jml_obj_function_stringify(
-                AS_FUNCTION(value));
-
-        case OBJ_CLOSURE:
-            return jml_obj_function_stringify(
-                AS_CLOSURE(value)->function);
-
-        case OBJ_UPVALUE:
-            return jml_strdup("<upvalue>");
-
-        case OBJ_COROUTINE:
-            return jml_strdup("<coroutine>");
+    jml_strbuf_init(&buf, 32);
+    jml_obj_write(&buf, value);
 
-        case OBJ_CFUNCTION:
-            return jml_obj_cfunction_stringify(
-                AS_CFUNCTION(value));
-
-        case OBJ_EXCEPTION: {
-            jml_obj_exception_t *exc = AS_EXCEPTION(value);
-
-            size_t size = exc->name->length + 32;
-            if (exc->module != NULL)
-                size += exc->module->name->length;
-
-            char *buffer = jml_alloc(size);
-            if (exc->module != NULL) {
-                sprintf(buffer, "<exception %.*s.%.*s>",
-                    (int32_t)exc->module->name->length,
-                    exc->module->name->chars,
-                    (int32_t)exc->name->length,
-                    exc->name->chars
-                );
-            } else {
-                sprintf(buffer, "<exception %.*s>",
-                    (int32_t)exc->name->length,
-                    exc->name->chars
-                );
-            }
-
-            return buffer;
-        }
-    }
-    return NULL;
+    return buf.chars;
 }
 
 
@@ -632,6 +442,9 @@ jml_obj_stringify_type(jml_value_t value)
         case OBJ_ARRAY:
             return "<type array>";
 
+        case OBJ_BUFFER:
+            return "<type buffer>";
+
         case OBJ_MAP:
             return "<type map>";
 
@@ -182,6 +182,18 @@ jml_serialize_bytecode(jml_bytecode_t *bytecode,
     memcpy(serial + posx, bytecode->lines, offset);
     posx += offset;
 
+    /*handlers*/
+    posx += jml_serialize_long(bytecode->handler_count, serial, size, posx);
+
+    for (uint32_t i = 0; i < bytecode->handler_count; ++i) {
+        jml_handler_t *handler = &bytecode->handlers[i];
+
+        posx += jml_serialize_long(handler->start, serial, size, posx);
+        posx += jml_serialize_long(handler->end, serial, size, posx);
+        posx += jml_serialize_long(handler->target, serial, size, posx);
+        posx += jml_serialize_long(handler->depth, serial, size, posx);
+    }
+
     /*values*/
     for (int i = 0; i < bytecode->constants.count; ++i) {
         posx += jml_serialize_value(
@@ -412,6 +424,23 @@ jml_deserialize_bytecode(uint8_t *serial, size_t length,
     }
     *pos += offset;
 
+    /*handlers*/
+    uint32_t handlers       = 0;
+    if (!jml_deserialize_long(serial, length, pos, &handlers))
+        goto err;
+
+    for (uint32_t i = 0; i < handlers; ++i) {
+        uint32_t start, end, target, depth;
+
+        if (!jml_deserialize_long(serial, length, pos, &start)
+            || !jml_deserialize_long(serial, length, pos, &end)
+            || !jml_deserialize_long(serial, length, pos, &target)
+            || !jml_deserialize_long(serial, length, pos, &depth))
+            goto err;
+
+        jml_bytecode_add_handler(bytecode, start, end, target, depth);
+    }
+
     /*values*/
     for (uint32_t i = 0; i < constants; ++i) {
         jml_value_t value;
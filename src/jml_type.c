@@ -48,26 +48,136 @@ jml_obj_string_allocate(char *chars, size_t length, uint32_t hash)
     string->length              = length;
     string->chars               = chars;
     string->hash                = hash;
+    string->format              = 0;
 
     jml_gc_exempt_push(OBJ_VAL(string));
-    jml_hashmap_set(&vm->strings, string, NONE_VAL);
+    jml_hashmap_set(
+        &vm->strings[STRINGS_SHARD(hash)], string, NONE_VAL);
     jml_gc_exempt_pop();
 
     return string;
 }
 
 
+/*wyhash, read a word at a time*/
+#define HASH_SECRET0                0xa0761d6478bd642full
+#define HASH_SECRET1                0xe7037ed1a0b428dbull
+#define HASH_SECRET2                0x8ebc6af09c88c6e3ull
+#define HASH_SECRET3                0x589965cc75374cc3ull
+
+
+static inline void
+jml_obj_string_hash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined __GNUC__ && defined __SIZEOF_INT128__
+    __extension__ unsigned __int128 r = *a;
+    r                          *= *b;
+    *a                          = (uint64_t)r;
+    *b                          = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c                          += lo < t;
+    *a                          = lo;
+    *b                          = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+
+static inline uint64_t
+jml_obj_string_hash_mix(uint64_t a, uint64_t b)
+{
+    jml_obj_string_hash_mum(&a, &b);
+    return a ^ b;
+}
+
+
+static inline uint64_t
+jml_obj_string_hash_r8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+
+static inline uint64_t
+jml_obj_string_hash_r4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+
 static uint32_t
 jml_obj_string_hash(const char *key, size_t length)
 {
-    uint32_t hash = 2166136261u;
+    const uint8_t *p            = (const uint8_t*)key;
+    uint64_t seed               = vm->hash_seed;
+    uint64_t a, b;
+
+    seed                       ^= jml_obj_string_hash_mix(
+        seed ^ HASH_SECRET0, HASH_SECRET1);
+
+    if (length <= 16) {
+        if (length >= 4) {
+            size_t half         = (length >> 3) << 2;
+            a = (jml_obj_string_hash_r4(p) << 32)
+                | jml_obj_string_hash_r4(p + half);
+            b = (jml_obj_string_hash_r4(p + length - 4) << 32)
+                | jml_obj_string_hash_r4(p + length - 4 - half);
+        } else if (length > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8)
+                | p[length - 1];
+            b = 0;
+        } else
+            a = b = 0;
+
+    } else {
+        size_t i                = length;
+
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = jml_obj_string_hash_mix(
+                    jml_obj_string_hash_r8(p) ^ HASH_SECRET1,
+                    jml_obj_string_hash_r8(p + 8) ^ seed);
+                see1 = jml_obj_string_hash_mix(
+                    jml_obj_string_hash_r8(p + 16) ^ HASH_SECRET2,
+                    jml_obj_string_hash_r8(p + 24) ^ see1);
+                see2 = jml_obj_string_hash_mix(
+                    jml_obj_string_hash_r8(p + 32) ^ HASH_SECRET3,
+                    jml_obj_string_hash_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
 
-    for (uint32_t i = 0; i < length; i++) {
-        hash ^= key[i];
-        hash *= 16777619;
+        while (i > 16) {
+            seed = jml_obj_string_hash_mix(
+                jml_obj_string_hash_r8(p) ^ HASH_SECRET1,
+                jml_obj_string_hash_r8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        a = jml_obj_string_hash_r8(p + i - 16);
+        b = jml_obj_string_hash_r8(p + i - 8);
     }
 
-    return hash;
+    a                          ^= HASH_SECRET1;
+    b                          ^= seed;
+    jml_obj_string_hash_mum(&a, &b);
+
+    uint64_t hash               = jml_obj_string_hash_mix(
+        a ^ HASH_SECRET0 ^ length, b ^ HASH_SECRET1);
+
+    return (uint32_t)(hash ^ (hash >> 32));
 }
 
 
@@ -78,7 +188,7 @@ jml_obj_string_take(char *chars, size_t length)
         chars, length);
 
     jml_obj_string_t *interned  = jml_hashmap_find(
-        &vm->strings, chars, length, hash);
+        &vm->strings[STRINGS_SHARD(hash)], chars, length, hash);
 
     if (interned != NULL) {
         FREE_ARRAY(char, chars, length + 1);
@@ -96,7 +206,7 @@ jml_obj_string_copy(const char *chars, size_t length)
         chars, length);
 
     jml_obj_string_t *interned  = jml_hashmap_find(
-        &vm->strings,chars, length, hash
+        &vm->strings[STRINGS_SHARD(hash)], chars, length, hash
     );
 
     if (interned != NULL)
@@ -140,14 +250,124 @@ jml_obj_array_add(jml_obj_array_t *source, jml_obj_array_t *dest)
     jml_gc_exempt_push(OBJ_VAL(source));
     jml_gc_exempt_push(OBJ_VAL(dest));
 
-    for (int i = 0; i < source->values.count; ++i)
-        jml_obj_array_append(dest, source->values.values[i]);
+    jml_value_array_extend(&dest->values,
+        source->values.values, source->values.count);
 
     jml_gc_exempt_pop();
     jml_gc_exempt_pop();
 }
 
 
+jml_obj_buffer_t *
+jml_obj_buffer_new(size_t length)
+{
+    jml_obj_buffer_t *buffer    = ALLOCATE_OBJ(
+        jml_obj_buffer_t, OBJ_BUFFER);
+
+    buffer->bytes               = NULL;
+    buffer->length              = 0;
+    buffer->capacity            = 0;
+    buffer->offset              = 0;
+    buffer->readonly            = false;
+    buffer->type                = BUFFER_U8;
+    buffer->owner               = NULL;
+    buffer->release             = NULL;
+
+    jml_gc_exempt_push(OBJ_VAL(buffer));
+    jml_obj_buffer_resize(buffer, length);
+    jml_gc_exempt_pop();
+
+    return buffer;
+}
+
+
+jml_obj_buffer_t *
+jml_obj_buffer_copy(const uint8_t *bytes, size_t length)
+{
+    jml_obj_buffer_t *buffer    = jml_obj_buffer_new(length);
+
+    if (length > 0)
+        memcpy(buffer->bytes, bytes, length);
+
+    return buffer;
+}
+
+
+jml_obj_buffer_t *
+jml_obj_buffer_wrap(uint8_t *bytes, size_t length, jml_release release)
+{
+    jml_obj_buffer_t *buffer    = ALLOCATE_OBJ(
+        jml_obj_buffer_t, OBJ_BUFFER);
+
+    buffer->bytes               = bytes;
+    buffer->length              = length;
+    buffer->capacity            = length;
+    buffer->offset              = 0;
+    buffer->readonly            = true;
+    buffer->type                = BUFFER_U8;
+    buffer->owner               = NULL;
+    buffer->release             = release;
+
+    return buffer;
+}
+
+
+jml_obj_buffer_t *
+jml_obj_buffer_view(jml_obj_buffer_t *buffer,
+    size_t offset, size_t length)
+{
+    jml_gc_exempt_push(OBJ_VAL(buffer));
+
+    jml_obj_buffer_t *view      = ALLOCATE_OBJ(
+        jml_obj_buffer_t, OBJ_BUFFER);
+
+    jml_gc_exempt_pop();
+
+    view->bytes                 = NULL;
+    view->length                = length;
+    view->capacity              = length;
+    view->offset                = buffer->offset + offset;
+    view->readonly              = buffer->readonly;
+    view->type                  = buffer->type;
+    view->owner                 = buffer->owner != NULL
+                                ? buffer->owner : buffer;
+    view->release               = NULL;
+
+    return view;
+}
+
+
+bool
+jml_obj_buffer_resize(jml_obj_buffer_t *buffer, size_t length)
+{
+    if (buffer->owner != NULL || buffer->readonly) {
+        if (length > buffer->capacity)
+            return false;
+
+        buffer->length          = length;
+        return true;
+    }
+
+    if (length > buffer->capacity) {
+        size_t capacity         = buffer->capacity < 8
+                                ? 8 : buffer->capacity;
+
+        while (capacity < length)
+            capacity           *= 2;
+
+        buffer->bytes           = GROW_ARRAY(
+            uint8_t, buffer->bytes, buffer->capacity, capacity);
+        buffer->capacity        = capacity;
+    }
+
+    if (length > buffer->length)
+        memset(buffer->bytes + buffer->length, 0, length - buffer->length);
+
+    buffer->length              = length;
+    return true;
+}
+
+
 jml_obj_map_t *
 jml_obj_map_new(void)
 {
@@ -205,6 +425,7 @@ jml_obj_instance_new(jml_obj_class_t *klass)
     instance->extra              = NULL;
 
     jml_hashmap_init(&instance->fields);
+    jml_hashmap_init(&instance->methods);
 
     return instance;
 }
@@ -226,6 +447,14 @@ jml_obj_method_new(jml_value_t receiver,
 
 jml_obj_closure_t *
 jml_obj_closure_new(jml_obj_function_t *function)
+{
+    return jml_obj_closure_flat(function, 0);
+}
+
+
+jml_obj_closure_t *
+jml_obj_closure_flat(jml_obj_function_t *function,
+    uint16_t copy_count)
 {
     jml_obj_upvalue_t **upvalues = ALLOCATE(
         jml_obj_upvalue_t*, function->upvalue_count);
@@ -234,12 +463,25 @@ jml_obj_closure_new(jml_obj_function_t *function)
         upvalues[i] = NULL;
     }
 
+    jml_obj_upvalue_t *copies   = ALLOCATE(jml_obj_upvalue_t, copy_count);
+
+    for (uint16_t i = 0; i < copy_count; i++) {
+        copies[i].obj.type      = OBJ_UPVALUE;
+        copies[i].obj.marked    = false;
+        copies[i].obj.next      = NULL;
+        copies[i].location      = &copies[i].closed;
+        copies[i].closed        = NONE_VAL;
+        copies[i].next          = NULL;
+    }
+
     jml_obj_closure_t *closure  = ALLOCATE_OBJ(
         jml_obj_closure_t, OBJ_CLOSURE);
 
     closure->function           = function;
     closure->upvalues           = upvalues;
     closure->upvalue_count      = function->upvalue_count;
+    closure->copies             = copies;
+    closure->copy_count         = copy_count;
 
     return closure;
 }
@@ -271,6 +513,7 @@ jml_obj_function_new(void)
     function->name               = NULL;
     function->klass_name         = NULL;
     function->module             = NULL;
+    function->closure            = NULL;
 
     jml_bytecode_init(&function->bytecode);
 
@@ -278,11 +521,39 @@ jml_obj_function_new(void)
 }
 
 
+static jml_stack_segment_t *
+jml_stack_segment_new(jml_stack_segment_t *prev, uint32_t capacity)
+{
+    jml_stack_segment_t *segment    = jml_reallocate(NULL, 0,
+        sizeof(jml_stack_segment_t) + sizeof(jml_value_t) * capacity);
+
+    segment->prev                   = prev;
+    segment->next                   = NULL;
+    segment->top                    = segment->values;
+    segment->capacity               = capacity;
+
+    return segment;
+}
+
+
+static void
+jml_stack_segment_free(jml_stack_segment_t *segment)
+{
+    while (segment != NULL) {
+        jml_stack_segment_t *next   = segment->next;
+
+        jml_reallocate(segment, sizeof(jml_stack_segment_t)
+            + sizeof(jml_value_t) * segment->capacity, 0);
+
+        segment                     = next;
+    }
+}
+
+
 jml_obj_coroutine_t *
 jml_obj_coroutine_new(jml_obj_closure_t *closure)
 {
-    jml_value_t *stack          = GROW_ARRAY(
-        jml_value_t, NULL, 0, STACK_MIN);
+    jml_stack_segment_t *segment    = jml_stack_segment_new(NULL, STACK_MIN);
 
     jml_call_frame_t *frames    = GROW_ARRAY(
         jml_call_frame_t, NULL, 0, FRAMES_MIN);
@@ -290,8 +561,9 @@ jml_obj_coroutine_new(jml_obj_closure_t *closure)
     jml_obj_coroutine_t *coro   = ALLOCATE_OBJ(
         jml_obj_coroutine_t, OBJ_COROUTINE);
 
-    coro->stack_capacity        = STACK_MIN;
-    coro->stack                 = stack;
+    coro->segment               = segment;
+    coro->stack_capacity        = segment->capacity;
+    coro->stack                 = segment->values;
     coro->stack_top             = coro->stack;
 
     coro->frame_capacity        = FRAMES_MIN;
@@ -304,6 +576,7 @@ jml_obj_coroutine_new(jml_obj_closure_t *closure)
     if (closure != NULL) {
         jml_call_frame_t *frame = &coro->frames[coro->frame_count++];
         frame->slots            = coro->stack;
+        frame->base             = coro->stack;
         frame->closure          = closure;
         frame->pc               = closure->function->bytecode.code;
 
@@ -315,36 +588,119 @@ jml_obj_coroutine_new(jml_obj_closure_t *closure)
 }
 
 
+/*
+ * copies the top count values to the segment above,
+ * returning where they were in the current one
+ */
+jml_value_t *
+jml_obj_coroutine_split(jml_obj_coroutine_t *coroutine, uint32_t count)
+{
+    jml_stack_segment_t *current    = coroutine->segment;
+    jml_stack_segment_t *next       = current->next;
+    uint32_t             needed     = count * 2 + STACK_RESERVE;
+
+    if (next == NULL || next->capacity < needed) {
+        uint32_t capacity           = current->capacity * 2;
+
+        if (capacity > STACK_SEGMENT)
+            capacity                = STACK_SEGMENT;
+
+        if (capacity < needed)
+            capacity                = needed;
+
+        jml_stack_segment_free(next);
+        current->next               = NULL;
+
+        next                        = jml_stack_segment_new(current, capacity);
+        current->next               = next;
+    }
+
+    jml_value_t *from               = coroutine->stack_top - count;
+    memcpy(next->values, from, sizeof(jml_value_t) * count);
+
+    current->top                    = from;
+    coroutine->segment              = next;
+    coroutine->stack                = next->values;
+    coroutine->stack_capacity       = next->capacity;
+    coroutine->stack_top            = next->values + count;
+
+    return from;
+}
+
+
+/*the running frame moves to a new segment, frames below stay in place*/
 void
 jml_obj_coroutine_grow(jml_obj_coroutine_t *coroutine)
 {
-    int capacity = GROW_CAPACITY(coroutine->stack_capacity);
-    jml_value_t *old_stack = coroutine->stack;
+    jml_call_frame_t *frame         = NULL;
+    jml_value_t      *start         = coroutine->stack;
+    jml_value_t      *end           = coroutine->stack_top;
+
+    if (coroutine->frame_count > 0) {
+        frame                       = &coroutine->frames[coroutine->frame_count - 1];
 
-    if (capacity >= STACK_MAX) {
-        jml_vm_error("OverflowErr: Stack overflow.");
-        return;
+        if (jml_stack_segment_owns(coroutine->segment, frame->slots))
+            start                   = frame->slots;
+        else
+            frame                   = NULL;
     }
 
-    coroutine->stack = GROW_ARRAY(jml_value_t, coroutine->stack,
-        coroutine->stack_capacity, capacity);
+    jml_obj_coroutine_split(coroutine, end - start);
 
-    coroutine->stack_capacity = capacity;
+    if (frame != NULL)
+        frame->slots                = coroutine->stack;
 
-    if (coroutine->stack != old_stack) {
-        for (uint32_t i = 0; i < coroutine->frame_count; ++i) {
-            jml_call_frame_t *frame = &coroutine->frames[i];
-            frame->slots = coroutine->stack + (frame->slots - old_stack);
-        }
+    for (jml_obj_upvalue_t *upvalue = coroutine->open_upvalues;
+        upvalue != NULL
+        && upvalue->location >= start && upvalue->location < end;
+        upvalue = upvalue->next) {
 
-        for (jml_obj_upvalue_t *upvalue = coroutine->open_upvalues;
-            upvalue != NULL; upvalue = upvalue->next) {
+        upvalue->location           = coroutine->stack + (upvalue->location - start);
+    }
+}
 
-            upvalue->location = coroutine->stack + (upvalue->location - old_stack);
-        }
 
-        coroutine->stack_top = coroutine->stack + (coroutine->stack_top - old_stack);
-    }
+void
+jml_obj_coroutine_seek(jml_obj_coroutine_t *coroutine, jml_value_t *top)
+{
+    jml_stack_segment_t *segment    = coroutine->segment;
+
+    while (!jml_stack_segment_owns(segment, top))
+        segment                     = segment->prev;
+
+    coroutine->segment              = segment;
+    coroutine->stack                = segment->values;
+    coroutine->stack_capacity       = segment->capacity;
+    coroutine->stack_top            = top;
+}
+
+
+void
+jml_obj_coroutine_reset(jml_obj_coroutine_t *coroutine)
+{
+    jml_stack_segment_t *segment    = coroutine->segment;
+
+    while (segment->prev != NULL)
+        segment                     = segment->prev;
+
+    coroutine->segment              = segment;
+    coroutine->stack                = segment->values;
+    coroutine->stack_capacity       = segment->capacity;
+    coroutine->stack_top            = segment->values;
+    coroutine->frame_count          = 0;
+}
+
+
+void
+jml_obj_coroutine_free(jml_obj_coroutine_t *coroutine)
+{
+    jml_stack_segment_t *segment    = coroutine->segment;
+
+    while (segment->prev != NULL)
+        segment                     = segment->prev;
+
+    FREE_ARRAY(jml_call_frame_t, coroutine->frames, coroutine->frame_capacity);
+    jml_stack_segment_free(segment);
 }
 
 
@@ -359,11 +715,69 @@ jml_obj_cfunction_new(jml_obj_string_t *name,
     cfunction->function             = function;
     cfunction->klass_name           = NULL;
     cfunction->module               = module;
+    cfunction->flags                = 0;
+    cfunction->arity                = 0;
 
+    memset(cfunction->params, 0, sizeof(cfunction->params));
     return cfunction;
 }
 
 
+static uint16_t
+jml_obj_cfunction_param(jml_value_t value)
+{
+    if (IS_NUM(value))
+        return JML_PARAM_NUM;
+
+    if (IS_BOOL(value))
+        return JML_PARAM_BOOL;
+
+    if (IS_NONE(value))
+        return JML_PARAM_NONE;
+
+    if (!IS_OBJ(value))
+        return JML_PARAM_ANY;
+
+    switch (OBJ_TYPE(value)) {
+        case OBJ_STRING:        return JML_PARAM_STRING;
+        case OBJ_ARRAY:         return JML_PARAM_ARRAY;
+        case OBJ_BUFFER:        return JML_PARAM_BUFFER;
+        case OBJ_MAP:           return JML_PARAM_MAP;
+        case OBJ_CLASS:         return JML_PARAM_CLASS;
+        case OBJ_INSTANCE:      return JML_PARAM_INSTANCE;
+        case OBJ_COROUTINE:     return JML_PARAM_COROUTINE;
+
+        case OBJ_METHOD:
+        case OBJ_CLOSURE:
+        case OBJ_CFUNCTION:     return JML_PARAM_FN;
+
+        default:                return JML_PARAM_ANY;
+    }
+}
+
+
+jml_obj_exception_t *
+jml_obj_cfunction_check(jml_obj_cfunction_t *cfunction,
+    int arg_count, jml_value_t *args)
+{
+    if (arg_count != cfunction->arity)
+        return jml_error_args(arg_count, cfunction->arity);
+
+    int checked = arg_count < JML_PARAM_MAX ? arg_count : JML_PARAM_MAX;
+
+    for (int i = 0; i < checked; ++i) {
+        uint16_t params = cfunction->params[i];
+
+        if (params != JML_PARAM_ANY
+            && !(jml_obj_cfunction_param(args[i]) & params))
+            return jml_error_params(cfunction->params,
+                cfunction->arity, i);
+    }
+
+    return NULL;
+}
+
+
 jml_obj_exception_t *
 jml_obj_exception_new(const char *name, const char *message)
 {
@@ -376,6 +790,7 @@ jml_obj_exception_new(const char *name, const char *message)
     exc->name                   = AS_STRING(jml_gc_exempt_peek(1));
     exc->message                = AS_STRING(jml_gc_exempt_peek(0));
     exc->module                 = NULL;
+    exc->render                 = NULL;
 
     jml_gc_exempt_pop();
     jml_gc_exempt_pop();
@@ -409,6 +824,44 @@ jml_obj_exception_format(const char *name,
     exc->name                   = name_string;
     exc->message                = message_string;
     exc->module                 = NULL;
+    exc->render                 = NULL;
+
+    return exc;
+}
+
+
+jml_obj_exception_t *
+jml_obj_exception_lazy(const char *name,
+    jml_exception_render render)
+{
+    jml_gc_exempt_push(jml_string_intern(name));
+
+    jml_obj_exception_t *exc    = ALLOCATE_OBJ(
+        jml_obj_exception_t, OBJ_EXCEPTION);
+
+    exc->name                   = AS_STRING(jml_gc_exempt_peek(0));
+    exc->message                = NULL;
+    exc->module                 = NULL;
+    exc->render                 = render;
+
+    jml_gc_exempt_pop();
 
     return exc;
 }
+
+
+jml_obj_string_t *
+jml_obj_exception_message(jml_obj_exception_t *exc)
+{
+    if (exc->message == NULL && exc->render != NULL) {
+        jml_gc_exempt_push(OBJ_VAL(exc));
+        exc->message            = exc->render(exc);
+        exc->render             = NULL;
+        jml_gc_exempt_pop();
+    }
+
+    if (exc->message == NULL)
+        exc->message            = jml_obj_string_copy("", 0);
+
+    return exc->message;
+}
@@ -1,6 +1,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 
 #include <jml.h>
 
@@ -102,6 +103,99 @@ jml_strcat(char *dest, char *src)
 }
 
 
+void
+jml_strbuf_init(jml_strbuf_t *buf, size_t capacity)
+{
+    buf->capacity   = capacity < 16 ? 16 : capacity;
+    buf->chars      = jml_alloc(buf->capacity);
+    buf->length     = 0;
+    buf->chars[0]   = '\0';
+}
+
+
+void
+jml_strbuf_reserve(jml_strbuf_t *buf, size_t extra)
+{
+    if (buf->length + extra < buf->capacity)
+        return;
+
+    while (buf->length + extra >= buf->capacity)
+        buf->capacity *= 2;
+
+    buf->chars      = jml_realloc(buf->chars, buf->capacity);
+}
+
+
+void
+jml_strbuf_append(jml_strbuf_t *buf, const char *chars, size_t length)
+{
+    jml_strbuf_reserve(buf, length);
+
+    memcpy(buf->chars + buf->length, chars, length);
+    buf->length    += length;
+    buf->chars[buf->length] = '\0';
+}
+
+
+void
+jml_strbuf_fill(jml_strbuf_t *buf, char c, size_t count)
+{
+    jml_strbuf_reserve(buf, count);
+
+    memset(buf->chars + buf->length, c, count);
+    buf->length    += count;
+    buf->chars[buf->length] = '\0';
+}
+
+
+void
+jml_strbuf_vprintf(jml_strbuf_t *buf, const char *format, va_list args)
+{
+    va_list copy;
+    va_copy(copy, args);
+
+    size_t available    = buf->capacity - buf->length;
+    int length          = vsnprintf(buf->chars + buf->length,
+        available, format, copy);
+
+    va_end(copy);
+
+    if (length <= 0) {
+        buf->chars[buf->length] = '\0';
+        return;
+    }
+
+    /*only formats twice when the output did not fit*/
+    if ((size_t)length >= available) {
+        jml_strbuf_reserve(buf, length);
+        vsnprintf(buf->chars + buf->length, length + 1, format, args);
+    }
+
+    buf->length    += length;
+}
+
+
+void
+jml_strbuf_printf(jml_strbuf_t *buf, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    jml_strbuf_vprintf(buf, format, args);
+    va_end(args);
+}
+
+
+void
+jml_strbuf_free(jml_strbuf_t *buf)
+{
+    jml_free(buf->chars);
+
+    buf->chars      = NULL;
+    buf->length     = 0;
+    buf->capacity   = 0;
+}
+
+
 bool
 jml_file_find(const char *filename, char *result)
 {
@@ -38,6 +38,50 @@ jml_value_array_write(jml_value_array_t *array,
 }
 
 
+void
+jml_value_array_reserve(jml_value_array_t *array,
+    int capacity)
+{
+    if (array->capacity >= capacity)
+        return;
+
+    array->values           = GROW_ARRAY(
+        jml_value_t, array->values,
+        array->capacity, capacity
+    );
+    array->capacity         = capacity;
+}
+
+
+void
+jml_value_array_extend(jml_value_array_t *array,
+    const jml_value_t *values, int count)
+{
+    if (count <= 0)
+        return;
+
+    if (array->capacity < array->count + count) {
+        /*values may point into the array itself*/
+        ptrdiff_t offset    = values - array->values;
+        bool inside         = array->values != NULL
+            && offset >= 0 && offset < array->count;
+
+        int capacity        = GROW_CAPACITY(array->capacity);
+        if (capacity < array->count + count)
+            capacity        = array->count + count;
+
+        jml_value_array_reserve(array, capacity);
+
+        if (inside)
+            values          = array->values + offset;
+    }
+
+    memcpy(array->values + array->count, values,
+        sizeof(jml_value_t) * count);
+    array->count           += count;
+}
+
+
 void
 jml_value_array_free(jml_value_array_t *array)
 {
@@ -46,11 +90,116 @@ jml_value_array_free(jml_value_array_t *array)
 }
 
 
+/*
+ * open addressing with a control byte per slot,
+ * probed one group of slots at a time
+ */
+#define MAP_GROUP                   16
+
+#define CTRL_EMPTY                  ((uint8_t)0x80)
+#define CTRL_DELETED                ((uint8_t)0xfe)
+#define CTRL_SENTINEL               ((uint8_t)0xff)
+
+#define CTRL_H1(hash)               ((hash) >> 7)
+#define CTRL_H2(hash)               ((uint8_t)((hash) & 0x7f))
+
+
+#if defined __GNUC__ && defined __SSE2__
+
+#include <emmintrin.h>
+
+static inline uint32_t
+jml_hashmap_match(const uint8_t *control, uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)control);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+
+static inline uint32_t
+jml_hashmap_match_empty(const uint8_t *control)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)control);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)CTRL_EMPTY)));
+}
+
+
+/*empty or deleted, the sentinel is the only greater value*/
+static inline uint32_t
+jml_hashmap_match_free(const uint8_t *control)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)control);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8((char)CTRL_SENTINEL), group));
+}
+
+#else
+
+static inline uint32_t
+jml_hashmap_match(const uint8_t *control, uint8_t h2)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < MAP_GROUP; ++i)
+        mask |= (uint32_t)(control[i] == h2) << i;
+
+    return mask;
+}
+
+
+static inline uint32_t
+jml_hashmap_match_empty(const uint8_t *control)
+{
+    return jml_hashmap_match(control, CTRL_EMPTY);
+}
+
+
+static inline uint32_t
+jml_hashmap_match_free(const uint8_t *control)
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < MAP_GROUP; ++i)
+        mask |= (uint32_t)(control[i] == CTRL_EMPTY
+            || control[i] == CTRL_DELETED) << i;
+
+    return mask;
+}
+
+#endif
+
+
+static inline int
+jml_hashmap_lowest(uint32_t mask)
+{
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+
+/*tables smaller than a group are padded with sentinels*/
+static inline int
+jml_hashmap_groups(int capacity)
+{
+    return capacity < MAP_GROUP ? 1 : capacity / MAP_GROUP;
+}
+
+
 void
 jml_hashmap_init(jml_hashmap_t *map)
 {
     map->count = 0;
-    map->capacity = -1;
+    map->tombs = 0;
+    map->capacity = 0;
+    map->control = NULL;
     map->entries = NULL;
 }
 
@@ -58,33 +207,55 @@ jml_hashmap_init(jml_hashmap_t *map)
 void
 jml_hashmap_free(jml_hashmap_t *map)
 {
-    FREE_ARRAY(jml_hashmap_entry_t, map->entries, map->capacity + 1);
+    if (map->capacity > 0) {
+        FREE_ARRAY(uint8_t, map->control,
+            jml_hashmap_groups(map->capacity) * MAP_GROUP);
+        FREE_ARRAY(jml_hashmap_entry_t, map->entries, map->capacity);
+    }
     jml_hashmap_init(map);
 }
 
 
-static jml_hashmap_entry_t *
-jml_hashmap_find_entry(jml_hashmap_entry_t *entries,
-    int capacity, jml_obj_string_t *key)
+static int
+jml_hashmap_find_index(jml_hashmap_t *map, jml_obj_string_t *key)
 {
-    uint32_t index = key->hash & capacity;
-    jml_hashmap_entry_t *tombstone = NULL;
-
-    while (true) {
-        jml_hashmap_entry_t *entry = &entries[index];
-
-        if (entry->key == NULL) {
-            if (IS_NONE(entry->value)) {
-                return tombstone != NULL ? tombstone : entry;
-            } else {
-                if (tombstone == NULL)
-                    tombstone = entry;
-            }
-        } else if (entry->key == key) {
-            return entry;
+    uint32_t mask   = jml_hashmap_groups(map->capacity) - 1;
+    uint32_t group  = CTRL_H1(key->hash) & mask;
+    uint8_t h2      = CTRL_H2(key->hash);
+
+    for (uint32_t step = 1; ; ++step) {
+        const uint8_t *control = &map->control[group * MAP_GROUP];
+
+        uint32_t match = jml_hashmap_match(control, h2);
+        while (match != 0) {
+            int index = group * MAP_GROUP + jml_hashmap_lowest(match);
+            if (map->entries[index].key == key)
+                return index;
+
+            match &= match - 1;
         }
 
-        index = (index + 1) & capacity;
+        if (jml_hashmap_match_empty(control) != 0)
+            return -1;
+
+        group = (group + step) & mask;
+    }
+}
+
+
+static int
+jml_hashmap_free_index(uint8_t *control, int capacity, uint32_t hash)
+{
+    uint32_t mask   = jml_hashmap_groups(capacity) - 1;
+    uint32_t group  = CTRL_H1(hash) & mask;
+
+    for (uint32_t step = 1; ; ++step) {
+        uint32_t match = jml_hashmap_match_free(&control[group * MAP_GROUP]);
+
+        if (match != 0)
+            return group * MAP_GROUP + jml_hashmap_lowest(match);
+
+        group = (group + step) & mask;
     }
 }
 
@@ -93,30 +264,59 @@ static void
 jml_hashmap_adjust_capacity(jml_hashmap_t *map,
     int capacity)
 {
+    int control_size = jml_hashmap_groups(capacity) * MAP_GROUP;
+    uint8_t *control = ALLOCATE(uint8_t, control_size);
     jml_hashmap_entry_t *entries = ALLOCATE(jml_hashmap_entry_t,
-        capacity + 1);
+        capacity);
 
-    for (int i = 0; i <= capacity; ++i) {
+    memset(control, CTRL_EMPTY, capacity);
+    memset(control + capacity, CTRL_SENTINEL, control_size - capacity);
+
+    for (int i = 0; i < capacity; ++i) {
         entries[i].key = NULL;
         entries[i].value = NONE_VAL;
     }
 
-    map->count = 0;
-    for (int i = 0; i <= map->capacity; ++i) {
+    for (int i = 0; i < map->capacity; ++i) {
         jml_hashmap_entry_t *entry = &map->entries[i];
         if (entry->key == NULL) continue;
 
-        jml_hashmap_entry_t *dest = jml_hashmap_find_entry(
-            entries, capacity, entry->key
+        int index = jml_hashmap_free_index(
+            control, capacity, entry->key->hash
         );
-        dest->key = entry->key;
-        dest->value = entry->value;
-        ++map->count;
+        control[index] = CTRL_H2(entry->key->hash);
+        entries[index] = *entry;
     }
 
-    FREE_ARRAY(jml_hashmap_entry_t, map->entries, map->capacity + 1);
-    map->entries = entries;
+    int count = map->count;
+    jml_hashmap_free(map);
+
+    map->count = count;
     map->capacity = capacity;
+    map->control = control;
+    map->entries = entries;
+}
+
+
+/*
+ * a slot may go back to empty only if its group
+ * still has an empty slot, as no probe went past it
+ */
+static void
+jml_hashmap_erase(jml_hashmap_t *map, int index)
+{
+    int group = index - index % MAP_GROUP;
+
+    if (jml_hashmap_match_empty(&map->control[group]) != 0)
+        map->control[index] = CTRL_EMPTY;
+    else {
+        map->control[index] = CTRL_DELETED;
+        ++map->tombs;
+    }
+
+    map->entries[index].key = NULL;
+    map->entries[index].value = NONE_VAL;
+    --map->count;
 }
 
 
@@ -127,14 +327,11 @@ jml_hashmap_get(jml_hashmap_t *map,
     if (map->count == 0)
         return false;
 
-    jml_hashmap_entry_t *entry = jml_hashmap_find_entry(
-        map->entries, map->capacity, key
-    );
-
-    if (entry->key == NULL)
+    int index = jml_hashmap_find_index(map, key);
+    if (index < 0)
         return false;
 
-    *value = &entry->value;
+    *value = &map->entries[index].value;
     return true;
 }
 
@@ -143,22 +340,37 @@ bool
 jml_hashmap_set(jml_hashmap_t *map,
     jml_obj_string_t *key, jml_value_t value)
 {
-    if (map->count + 1 > (map->capacity + 1) * MAP_LOAD_MAX) {
-        int capacity = GROW_CAPACITY(map->capacity + 1) - 1;
+    if (map->count > 0) {
+        int index = jml_hashmap_find_index(map, key);
+
+        if (index >= 0) {
+            map->entries[index].value = value;
+            return false;
+        }
+    }
+
+    /*rehash in place when tombstones make up the load*/
+    if (map->count + map->tombs + 1 > map->capacity * MAP_LOAD_MAX) {
+        int capacity = map->capacity;
+        if ((map->count + 1) * 2 > capacity * MAP_LOAD_MAX)
+            capacity = GROW_CAPACITY(capacity);
+
         jml_hashmap_adjust_capacity(map, capacity);
     }
 
-    jml_hashmap_entry_t *entry = jml_hashmap_find_entry(
-        map->entries, map->capacity, key
+    int index = jml_hashmap_free_index(
+        map->control, map->capacity, key->hash
     );
 
-    bool new_key = entry->key == NULL;
-    if (new_key && IS_NONE(entry->value))
-        ++map->count;
+    if (map->control[index] == CTRL_DELETED)
+        --map->tombs;
+
+    map->control[index] = CTRL_H2(key->hash);
+    map->entries[index].key = key;
+    map->entries[index].value = value;
+    ++map->count;
 
-    entry->key = key;
-    entry->value = value;
-    return new_key;
+    return true;
 }
 
 
@@ -169,17 +381,12 @@ jml_hashmap_pop(jml_hashmap_t *map,
     if (map->count == 0)
         return false;
 
-    jml_hashmap_entry_t *entry = jml_hashmap_find_entry(
-        map->entries, map->capacity, key
-    );
-
-    if (entry->key == NULL)
+    int index = jml_hashmap_find_index(map, key);
+    if (index < 0)
         return false;
 
-    *value = entry->value;
-
-    entry->key = NULL;
-    entry->value = TRUE_VAL;
+    *value = map->entries[index].value;
+    jml_hashmap_erase(map, index);
 
     return true;
 }
@@ -191,14 +398,10 @@ jml_hashmap_del(jml_hashmap_t *map,
 {
     if (map->count == 0)    return false;
 
-    jml_hashmap_entry_t *entry = jml_hashmap_find_entry(
-        map->entries, map->capacity, key
-    );
-    if (entry->key == NULL) return false;
-
-    entry->key = NULL;
-    entry->value = TRUE_VAL;
+    int index = jml_hashmap_find_index(map, key);
+    if (index < 0)          return false;
 
+    jml_hashmap_erase(map, index);
     return true;
 }
 
@@ -207,7 +410,7 @@ void
 jml_hashmap_add(jml_hashmap_t *source,
     jml_hashmap_t *dest)
 {
-    for (int i = 0; i <= source->capacity; ++i) {
+    for (int i = 0; i < source->capacity; ++i) {
         jml_hashmap_entry_t *entry = &source->entries[i];
 
         if (entry->key != NULL) {
@@ -222,42 +425,61 @@ jml_hashmap_find(jml_hashmap_t *map, const char *chars,
     size_t length, uint32_t hash)
 {
     if (map->count == 0) return NULL;
-    uint32_t index = hash & map->capacity;
 
-    while (true) {
-        jml_hashmap_entry_t *entry= &map->entries[index];
+    uint32_t mask   = jml_hashmap_groups(map->capacity) - 1;
+    uint32_t group  = CTRL_H1(hash) & mask;
+    uint8_t h2      = CTRL_H2(hash);
 
-        if (entry->key == NULL) {
-            if (IS_NONE(entry->value)) return NULL;
+    for (uint32_t step = 1; ; ++step) {
+        const uint8_t *control = &map->control[group * MAP_GROUP];
 
-        } else if ((entry->key->length == length)
-            && (entry->key->hash == hash)
-            && (memcmp(entry->key->chars, chars, length) == 0))
+        uint32_t match = jml_hashmap_match(control, h2);
+        while (match != 0) {
+            jml_obj_string_t *key = map->entries[
+                group * MAP_GROUP + jml_hashmap_lowest(match)].key;
+
+            if ((key->length == length)
+                && (key->hash == hash)
+                && (memcmp(key->chars, chars, length) == 0))
+
+                return key;
+
+            match &= match - 1;
+        }
 
-                return entry->key;
+        if (jml_hashmap_match_empty(control) != 0)
+            return NULL;
 
-        index = (index + 1) & map->capacity;
+        group = (group + step) & mask;
     }
 }
 
 
+/*drops tombstones and halves down to a quarter of the load*/
 void
-jml_hashmap_remove_white(jml_hashmap_t *map)
+jml_hashmap_shrink(jml_hashmap_t *map)
 {
-    for (int i = 0; i <= map->capacity; ++i) {
-        jml_hashmap_entry_t *entry = &map->entries[i];
-        if (entry->key != NULL && !(entry->key->obj.marked)) {
-            jml_hashmap_del(map, entry->key);
-        }
+    if (map->count == 0) {
+        jml_hashmap_free(map);
+        return;
     }
+
+    int capacity = map->capacity;
+    while (capacity > 8 && map->count * 4 <= capacity * MAP_LOAD_MAX)
+        capacity /= 2;
+
+    if (capacity < map->capacity || map->tombs > map->count)
+        jml_hashmap_adjust_capacity(map, capacity);
 }
 
 
 void
 jml_hashmap_mark(jml_hashmap_t *map)
 {
-    for (int i = 0; i <= map->capacity; ++i) {
+    for (int i = 0; i < map->capacity; ++i) {
         jml_hashmap_entry_t *entry = &map->entries[i];
+        if (entry->key == NULL) continue;
+
         jml_gc_mark_obj((jml_obj_t*)entry->key);
         jml_gc_mark_value(entry->value);
     }
@@ -271,7 +493,7 @@ jml_hashmap_iterator(jml_hashmap_t *map)
         map->count * sizeof(jml_hashmap_entry_t));
 
     int count = 0;
-    for (int i = 0; i <= map->capacity; ++i) {
+    for (int i = 0; i < map->capacity; ++i) {
         jml_hashmap_entry_t entry = map->entries[i];
 
         if (entry.key == NULL)      continue;
@@ -304,6 +526,16 @@ jml_value_equal(jml_value_t a, jml_value_t b)
         return true;
     }
 
+    if (IS_BUFFER(a) && IS_BUFFER(b)) {
+        if (AS_BUFFER(a)->length != AS_BUFFER(b)->length
+            || AS_BUFFER(a)->type != AS_BUFFER(b)->type)
+            return false;
+
+        return AS_BUFFER(a)->length == 0
+            || memcmp(jml_obj_buffer_data(AS_BUFFER(a)),
+            jml_obj_buffer_data(AS_BUFFER(b)), AS_BUFFER(a)->length) == 0;
+    }
+
     return a == b;
 
 #else
@@ -333,6 +565,16 @@ jml_value_equal(jml_value_t a, jml_value_t b)
                 return true;
             }
 
+            if (IS_BUFFER(a) && IS_BUFFER(b)) {
+                if (AS_BUFFER(a)->length != AS_BUFFER(b)->length
+                    || AS_BUFFER(a)->type != AS_BUFFER(b)->type)
+                    return false;
+
+                return AS_BUFFER(a)->length == 0
+                    || memcmp(jml_obj_buffer_data(AS_BUFFER(a)),
+                    jml_obj_buffer_data(AS_BUFFER(b)), AS_BUFFER(a)->length) == 0;
+            }
+
             return AS_OBJ(a) == AS_OBJ(b);
         }
 
@@ -2,6 +2,7 @@
 #include <stdarg.h>
 #include <math.h>
 #include <string.h>
+#include <time.h>
 
 #include <jml.h>
 
@@ -11,6 +12,7 @@
 #include <jml/jml_type.h>
 #include <jml/jml_module.h>
 #include <jml/jml_util.h>
+#include <jml/jml_string.h>
 
 #define JML_VM_INTERNAL
 #include <jml/jml_vm.h>
@@ -43,19 +45,40 @@ jml_vm_init(jml_vm_t *vm, jml_vm_context_t *context)
     vm->gray_stack          = NULL;
 
     vm->running             = NULL;
+    vm->recursion_limit     = FRAMES_MAX;
     vm->current             = NULL;
     vm->external            = NULL;
+    vm->callback            = NULL;
+    vm->raised              = NULL;
+    vm->callback_depth      = 0;
 
     vm->compilers[0]        = NULL;
     vm->compiler_top        = vm->compilers;
 
-    vm->exempt_top          = vm->exempt_stack;
+    vm->exempt_count        = 0;
+    vm->exempt_capacity     = 0;
+    vm->exempt_stack        = NULL;
 
     jml_hashmap_init(&vm->globals);
-    jml_hashmap_init(&vm->strings);
+    for (int i = 0; i < STRINGS_SHARDS; ++i)
+        jml_hashmap_init(&vm->strings[i]);
+    vm->strings_dirty       = 0;
+    vm->format_hint         = 0;
+    for (int i = 0; i < FORMAT_CACHE; ++i)
+        vm->formats[i]      = NULL;
+
+    /*terminals see each line, pipes and files get whole blocks*/
+    jml_strbuf_init(&vm->output, OUTPUT_MAX);
+    vm->output_mode         = jml_isatty_stdout()
+        ? OUTPUT_LINE : OUTPUT_BLOCK;
     jml_hashmap_init(&vm->modules);
     jml_hashmap_init(&vm->builtins);
 
+    /*per-process seed, as string hashes never leave the vm*/
+    vm->hash_seed           = (uint64_t)time(NULL) * 0x9e3779b97f4a7c15u
+        ^ (uint64_t)clock() ^ (uint64_t)(uintptr_t)vm
+        ^ ((uint64_t)(uintptr_t)&context << 16);
+
     vm->main_string         = NULL;
     vm->module_string       = NULL;
     vm->path_string         = NULL;
@@ -76,6 +99,8 @@ jml_vm_init(jml_vm_t *vm, jml_vm_context_t *context)
     vm->get_string          = NULL;
     vm->set_string          = NULL;
     vm->size_string         = NULL;
+    vm->iter_string         = NULL;
+    vm->next_string         = NULL;
     vm->print_string        = NULL;
     vm->str_string          = NULL;
     vm->inherit_string      = NULL;
@@ -100,6 +125,8 @@ jml_vm_init(jml_vm_t *vm, jml_vm_context_t *context)
     vm->get_string          = jml_obj_string_copy("__get", 5);
     vm->set_string          = jml_obj_string_copy("__set", 5);
     vm->size_string         = jml_obj_string_copy("__size", 6);
+    vm->iter_string         = jml_obj_string_copy("__iter", 6);
+    vm->next_string         = jml_obj_string_copy("__next", 6);
     vm->print_string        = jml_obj_string_copy("__print", 7);
     vm->str_string          = jml_obj_string_copy("__str", 5);
     vm->inherit_string      = jml_obj_string_copy("__inherit", 9);
@@ -114,8 +141,11 @@ jml_vm_free(void)
     if (vm == NULL)
         return;
 
+    jml_output_flush();
+
     jml_hashmap_free(&vm->globals);
-    jml_hashmap_free(&vm->strings);
+    for (int i = 0; i < STRINGS_SHARDS; ++i)
+        jml_hashmap_free(&vm->strings[i]);
     jml_hashmap_free(&vm->modules);
     jml_hashmap_free(&vm->builtins);
 
@@ -139,6 +169,8 @@ jml_vm_free(void)
     vm->get_string          = NULL;
     vm->set_string          = NULL;
     vm->size_string         = NULL;
+    vm->iter_string         = NULL;
+    vm->next_string         = NULL;
     vm->print_string        = NULL;
     vm->str_string          = NULL;
     vm->inherit_string      = NULL;
@@ -146,8 +178,12 @@ jml_vm_free(void)
     vm->running             = NULL;
     vm->current             = NULL;
     vm->external            = NULL;
+    vm->callback            = NULL;
+    vm->raised              = NULL;
+    vm->callback_depth      = 0;
 
     jml_gc_free_objs();
+    jml_strbuf_free(&vm->output);
 
     JML_ASSERT(
         vm->allocated == 0,
@@ -275,6 +311,8 @@ jml_vm_error(const char *format, ...)
     if (vm->running == NULL)
         return;
 
+    jml_output_flush();
+
 #ifndef JML_BACKTRACE
     if (vm->external != NULL) {
         jml_call_frame_t    *frame    = &vm->running->frames[0];
@@ -365,48 +403,102 @@ jml_vm_error(const char *format, ...)
 }
 
 
+void
+jml_vm_report(jml_obj_exception_t *exc)
+{
+    jml_obj_string_t *message       = jml_obj_exception_message(exc);
+
+    jml_vm_error(
+        "%.*s: %.*s",
+        (int32_t)exc->name->length, exc->name->chars,
+        (int32_t)message->length, message->chars
+    );
+}
+
+
 /*forwarded declaration*/
 static void jml_vm_upvalue_close(
     jml_obj_coroutine_t *coroutine, jml_value_t *last);
 
 
+/*
+ *typed cfunctions are checked here once,
+ *NOEXC ones skip the look at the result
+ */
+static inline jml_obj_exception_t *
+jml_vm_cfunction_call(jml_obj_cfunction_t *cfunction,
+    int arg_count, jml_value_t *args, jml_value_t *result)
+{
+    uint8_t flags                   = cfunction->flags;
+
+    if (flags & JML_CFUNC_TYPED) {
+        jml_obj_exception_t *exc    = jml_obj_cfunction_check(
+            cfunction, arg_count, args);
+
+        if (exc != NULL)
+            return exc;
+    }
+
+    jml_value_t value               = cfunction->function(arg_count, args);
+
+    if (result != NULL)
+        *result                     = value;
+
+    if (!(flags & JML_CFUNC_NOEXC) && IS_EXCEPTION(value))
+        return AS_EXCEPTION(value);
+
+    return NULL;
+}
+
+
+/*handler tables are only looked at once something is thrown*/
 static bool
 jml_vm_exception(jml_obj_exception_t *exc)
 {
-    for (int32_t i = vm->running->frame_count; i > 0; --i) {
-        jml_call_frame_t *frame      = &vm->running->frames[i - 1];
-        uint32_t pclen = frame->pc - frame->closure->function->bytecode.code;
-
-        if ((pclen > 3 && frame->pc[-3] == OP_TRY_CALL)
-            || (pclen > 4 && frame->pc[-4] == OP_TRY_INVOKE)
-            || (pclen > 6 && frame->pc[-6] == EXTENDED_OP(OP_TRY_INVOKE))
-            || (pclen > 4 && frame->pc[-4] == OP_TRY_SUPER_INVOKE)
-            || (pclen > 6 && frame->pc[-6] == EXTENDED_OP(OP_TRY_SUPER_INVOKE))) {
-
-            if (vm->external != NULL) {
-                vm->external         = NULL;
-                jml_vm_push(OBJ_VAL(exc));
-                return true;
+    jml_obj_coroutine_t *coroutine  = vm->running;
+
+    for (int32_t i = coroutine->frame_count - 1; i >= 0; --i) {
+        jml_call_frame_t *frame     = &coroutine->frames[i];
+        jml_bytecode_t   *bytecode  = &frame->closure->function->bytecode;
+        jml_handler_t    *handler   = jml_bytecode_find_handler(
+            bytecode, (uint32_t)(frame->pc - bytecode->code));
+
+        if (handler == NULL)
+            continue;
+
+        vm->external                = NULL;
+
+        if (handler->target == HANDLER_CALL) {
+            /*the callee returns the exception instead*/
+            if (i + 1 < (int32_t)coroutine->frame_count) {
+                jml_call_frame_t *callee = &coroutine->frames[i + 1];
+
+                jml_vm_upvalue_close(coroutine, callee->slots);
+                coroutine->frame_count = i + 1;
+                jml_obj_coroutine_seek(coroutine, callee->base);
             }
 
-            int locals = frame->pc[-1] + 1;
-            printf("%d\n\n", locals);
-            jml_vm_upvalue_close(vm->running, frame->slots + locals);
-            vm->running->frame_count = i;
-            vm->running->stack_top   = frame->slots + locals;
+        } else {
+            jml_value_t *top        = frame->slots + handler->depth;
 
-            jml_vm_push(OBJ_VAL(exc));
-            jml_vm_rot();
-            return true;
+            jml_vm_upvalue_close(coroutine, top);
+            coroutine->frame_count  = i + 1;
+            jml_obj_coroutine_seek(coroutine, top);
+            frame->pc               = bytecode->code + handler->target;
         }
+
+        jml_vm_push(OBJ_VAL(exc));
+        return true;
     }
 
-    jml_vm_error(
-        "%.*s: %.*s",
-        (int32_t)exc->name->length, exc->name->chars,
-        (int32_t)exc->message->length, exc->message->chars
-    );
+    /*a callback hands the exception back to its cfunction*/
+    if (coroutine == vm->callback) {
+        vm->external                = NULL;
+        vm->raised                  = exc;
+        return false;
+    }
 
+    jml_vm_report(exc);
     return false;
 }
 
@@ -454,7 +546,7 @@ jml_vm_call(jml_obj_coroutine_t *coroutine,
         }
     }
 
-    if (coroutine->frame_count == FRAMES_MAX) {
+    if (coroutine->frame_count >= vm->recursion_limit) {
         jml_vm_error("OverflowErr: Scope depth overflow.");
         return false;
     }
@@ -466,15 +558,22 @@ jml_vm_call(jml_obj_coroutine_t *coroutine,
             coroutine->frame_capacity, new_capacity
         );
         coroutine->frame_capacity = new_capacity;
-        jml_obj_coroutine_grow(coroutine);
     }
 
+    uint32_t window = (closure->function->variadic
+        ? closure->function->arity : (uint32_t)arg_count) + 1;
+
+    /*a frame that might not fit starts a new segment*/
+    jml_value_t *base = coroutine->stack_top + STACK_RESERVE
+        >= coroutine->stack + coroutine->stack_capacity
+        ? jml_obj_coroutine_split(coroutine, window)
+        : coroutine->stack_top - window;
+
     jml_call_frame_t *frame = &coroutine->frames[coroutine->frame_count++];
     frame->closure = closure;
     frame->pc = closure->function->bytecode.code;
-    frame->slots = closure->function->variadic
-        ? coroutine->stack_top - closure->function->arity - 1
-        : coroutine->stack_top - arg_count - 1;
+    frame->slots = coroutine->stack_top - window;
+    frame->base = base;
 
     return true;
 }
@@ -511,15 +610,14 @@ jml_vm_call_value(jml_obj_coroutine_t *coroutine,
                         ++arg_count;
 
                         jml_obj_cfunction_t *cfunction_obj  = AS_CFUNCTION(*initializer);
-                        jml_cfunction        cfunction      = cfunction_obj->function;
-                        jml_value_t          result         = cfunction(
-                            arg_count, coroutine->stack_top - arg_count);
+                        jml_obj_exception_t *exception      = jml_vm_cfunction_call(
+                            cfunction_obj, arg_count, coroutine->stack_top - arg_count, NULL);
 
                         coroutine->stack_top                -= arg_count + 1;
 
-                        if (IS_EXCEPTION(result)) {
-                            jml_obj_exception_t *exception  = AS_EXCEPTION(result);
-                            exception->module               = cfunction_obj->module;
+                        if (exception != NULL) {
+                            if (exception->module == NULL)
+                                exception->module           = cfunction_obj->module;
                             vm->external                    = cfunction_obj;
                             return jml_vm_exception(exception);
 
@@ -563,15 +661,16 @@ jml_vm_call_value(jml_obj_coroutine_t *coroutine,
 
             case OBJ_CFUNCTION: {
                 jml_obj_cfunction_t *cfunction_obj  = AS_CFUNCTION(callee);
-                jml_cfunction        cfunction      = cfunction_obj->function;
-                jml_value_t          result         = cfunction(
-                    arg_count, coroutine->stack_top - arg_count);
+                jml_value_t          result;
+                jml_obj_exception_t *exception      = jml_vm_cfunction_call(
+                    cfunction_obj, arg_count, coroutine->stack_top - arg_count, &result);
 
                 coroutine->stack_top                -= arg_count + 1;
 
-                if (IS_EXCEPTION(result)) {
-                    jml_obj_exception_t *exception  = AS_EXCEPTION(result);
-                    exception->module               = cfunction_obj->module;
+                /*exceptions passed on from a callback keep their module*/
+                if (exception != NULL) {
+                    if (exception->module == NULL)
+                        exception->module           = cfunction_obj->module;
                     vm->external                    = cfunction_obj;
                     return jml_vm_exception(exception);
 
@@ -636,6 +735,17 @@ jml_vm_invoke_instance(jml_obj_coroutine_t *coroutine,
 }
 
 
+/*instances without '__next' are walked with '__size' and '__get'*/
+static inline bool
+jml_vm_iter_indexed(jml_obj_instance_t *instance)
+{
+    jml_value_t *temp;
+
+    return jml_hashmap_get(&instance->klass->statics, vm->size_string, &temp)
+        && jml_hashmap_get(&instance->klass->statics, vm->get_string, &temp);
+}
+
+
 static bool
 jml_vm_invoke(jml_obj_coroutine_t *coroutine,
     jml_obj_string_t *name, int arg_count)
@@ -651,14 +761,15 @@ jml_vm_invoke(jml_obj_coroutine_t *coroutine,
             return jml_vm_call_value(coroutine, *value, arg_count);
         }
 
-        if (!jml_vm_invoke_instance(coroutine, instance, name, arg_count)) {
+        /*a method that raised is not an undefined one*/
+        if (!jml_hashmap_get(&instance->klass->statics, name, &value)) {
             jml_vm_error(
                 "UndefErr: Undefined property '%.*s'.",
                 (int32_t)name->length, name->chars
             );
             return false;
         }
-        return true;
+        return jml_vm_invoke_instance(coroutine, instance, name, arg_count);
 
     } else if (IS_CLASS(receiver)) {
         jml_value_t *value;
@@ -685,33 +796,19 @@ jml_vm_invoke(jml_obj_coroutine_t *coroutine,
             return jml_vm_call_value(coroutine, *value, arg_count);
         }
 
-#ifndef JML_LAZY_IMPORT
-        else {
-            jml_vm_error(
-                "UndefErr: Undefined property '%.*s'.",
-                (int32_t)name->length, name->chars
-            );
-            return false;
-        }
-#else
-        else if (module->handle != NULL) {
-            jml_obj_cfunction_t *cfunction = jml_module_get_raw(
-                module, name->chars, true);
-
-            if (cfunction == NULL || cfunction->function == NULL) {
-                jml_vm_error(
-                    "UndefErr: Undefined property '%.*s'.",
-                    name->length, name->chars
-                );
-                return false;
-            }
+#ifdef JML_LAZY_IMPORT
+        jml_obj_cfunction_t *cfunction = jml_module_lazy_bind(module, name);
 
-            jml_vm_push(OBJ_VAL(cfunction));
-            jml_hashmap_set(&module->globals, name, jml_vm_peek(0));
-            jml_vm_pop();
-            return jml_vm_call_value(OBJ_VAL(cfunction), arg_count);
+        if (cfunction != NULL) {
+            coroutine->stack_top[-arg_count - 1] = OBJ_VAL(cfunction);
+            return jml_vm_call_value(coroutine, OBJ_VAL(cfunction), arg_count);
         }
 #endif
+        jml_vm_error(
+            "UndefErr: Undefined property '%.*s'.",
+            (int32_t)name->length, name->chars
+        );
+        return false;
     }
 
     jml_vm_error(
@@ -722,6 +819,30 @@ jml_vm_invoke(jml_obj_coroutine_t *coroutine,
 }
 
 
+/*instances keep the methods bound to them, keyed by name*/
+static jml_value_t
+jml_vm_method_bind(jml_value_t receiver,
+    jml_obj_string_t *name, jml_obj_closure_t *method)
+{
+    jml_value_t *cached;
+
+    if (IS_INSTANCE(receiver)
+        && jml_hashmap_get(&AS_INSTANCE(receiver)->methods, name, &cached)
+        && AS_METHOD(*cached)->method == method)
+        return *cached;
+
+    jml_value_t bound = OBJ_VAL(jml_obj_method_new(receiver, method));
+
+    if (IS_INSTANCE(receiver)) {
+        jml_gc_exempt_push(bound);
+        jml_hashmap_set(&AS_INSTANCE(receiver)->methods, name, bound);
+        jml_gc_exempt_pop();
+    }
+
+    return bound;
+}
+
+
 static bool
 jml_vm_class_field_bind(jml_obj_class_t *klass, jml_obj_string_t *name)
 {
@@ -740,9 +861,9 @@ jml_vm_class_field_bind(jml_obj_class_t *klass, jml_obj_string_t *name)
         field = OBJ_VAL(AS_CFUNCTION(*value));
 
     } else if (IS_CLOSURE(*value)) {
-        field = OBJ_VAL(jml_obj_method_new(
-            jml_vm_peek(0), AS_CLOSURE(*value)
-        ));
+        field = jml_vm_method_bind(
+            jml_vm_peek(0), name, AS_CLOSURE(*value)
+        );
 
     } else
         field = *value;
@@ -770,7 +891,9 @@ jml_vm_upvalue_capture(jml_obj_coroutine_t *coroutine, jml_value_t *local)
     jml_obj_upvalue_t *previous     = NULL;
     jml_obj_upvalue_t *upvalue      = coroutine->open_upvalues;
 
+    /*upvalues of the current segment come first*/
     while (upvalue != NULL
+        && jml_stack_segment_owns(coroutine->segment, upvalue->location)
         && upvalue->location > local) {
 
         previous = upvalue;
@@ -792,13 +915,25 @@ jml_vm_upvalue_capture(jml_obj_coroutine_t *coroutine, jml_value_t *local)
 }
 
 
+/*everything in segments above the one of last is closed as well*/
 static void
 jml_vm_upvalue_close(jml_obj_coroutine_t *coroutine, jml_value_t *last)
 {
-    while (coroutine->open_upvalues != NULL
-        && coroutine->open_upvalues->location >= last) {
+    jml_stack_segment_t *segment    = coroutine->segment;
 
+    while (coroutine->open_upvalues != NULL) {
         jml_obj_upvalue_t *upvalue  = coroutine->open_upvalues;
+
+        if (jml_stack_segment_owns(segment, last)) {
+            if (!jml_stack_segment_owns(segment, upvalue->location)
+                || upvalue->location < last)
+                break;
+
+        } else if (!jml_stack_segment_owns(segment, upvalue->location)) {
+            segment                 = segment->prev;
+            continue;
+        }
+
         upvalue->closed             = *upvalue->location;
         upvalue->location           = &upvalue->closed;
         coroutine->open_upvalues    = upvalue->next;
@@ -806,6 +941,79 @@ jml_vm_upvalue_close(jml_obj_coroutine_t *coroutine, jml_value_t *last)
 }
 
 
+/*reads the capture operands following OP_CLOSURE*/
+static uint8_t *
+jml_vm_closure_push(jml_obj_coroutine_t *coroutine, jml_call_frame_t *frame,
+    jml_obj_function_t *function, uint8_t *pc)
+{
+    /*without captures every evaluation yields the same closure*/
+    if (function->upvalue_count == 0) {
+        if (function->closure == NULL)
+            function->closure = jml_obj_closure_new(function);
+
+        jml_vm_push(OBJ_VAL(function->closure));
+        return pc;
+    }
+
+    uint16_t copy_count             = 0;
+    for (uint32_t i = 0; i < function->upvalue_count; ++i) {
+        if (pc[i * 2] & CAPTURE_COPY)
+            ++copy_count;
+    }
+
+    jml_obj_closure_t *closure      = jml_obj_closure_flat(function, copy_count);
+    jml_vm_push(OBJ_VAL(closure));
+
+    for (int i = 0, copy = 0; i < closure->upvalue_count; ++i) {
+        uint8_t capture             = *pc++;
+        uint8_t index               = *pc++;
+
+        if (capture & CAPTURE_COPY) {
+            jml_obj_upvalue_t *upvalue = &closure->copies[copy++];
+
+            if (capture & CAPTURE_LOCAL)
+                upvalue->closed     = frame->slots[index];
+            else
+                upvalue->closed     = *frame->closure->upvalues[index]->location;
+
+            closure->upvalues[i]    = upvalue;
+
+        } else if (capture & CAPTURE_LOCAL)
+            closure->upvalues[i]    = jml_vm_upvalue_capture(coroutine, frame->slots + index);
+        else
+            closure->upvalues[i]    = frame->closure->upvalues[index];
+    }
+
+    return pc;
+}
+
+
+/*moves the frame pushed by a call in tail position over its caller*/
+static void
+jml_vm_call_tail(jml_obj_coroutine_t *coroutine, uint32_t depth)
+{
+    if (coroutine->frame_count != depth + 1)
+        return;
+
+    jml_call_frame_t *caller        = &coroutine->frames[depth - 1];
+    jml_call_frame_t *callee        = &coroutine->frames[depth];
+    ptrdiff_t         count         = coroutine->stack_top - callee->slots;
+
+    jml_vm_upvalue_close(coroutine, caller->slots);
+
+    /*a callee that opened a segment keeps it*/
+    if (jml_stack_segment_owns(coroutine->segment, caller->slots)) {
+        memmove(caller->slots, callee->slots, sizeof(jml_value_t) * count);
+        coroutine->stack_top        = caller->slots + count;
+    } else
+        caller->slots               = callee->slots;
+
+    caller->closure                 = callee->closure;
+    caller->pc                      = callee->pc;
+    --coroutine->frame_count;
+}
+
+
 static void
 jml_string_concatenate(void)
 {
@@ -825,17 +1033,21 @@ jml_string_concatenate(void)
 }
 
 
+/*reserves room for extra values, so appending them can't collect*/
 static jml_obj_array_t *
-jml_array_copy(jml_obj_array_t *array)
+jml_array_copy(jml_obj_array_t *array, int extra)
 {
-    jml_vm_push(OBJ_VAL(jml_obj_array_new()));
+    jml_obj_array_t        *copy    = jml_obj_array_new();
 
-    for (int i = 0; i < array->values.count; ++i) {
-        jml_obj_array_append(AS_ARRAY(jml_vm_peek(0)),
-            array->values.values[i]);
-    }
+    jml_vm_push(OBJ_VAL(copy));
+    jml_value_array_reserve(&copy->values,
+        array->values.count + extra);
+    jml_vm_pop();
+
+    jml_value_array_extend(&copy->values,
+        array->values.values, array->values.count);
 
-    return AS_ARRAY(jml_vm_pop());
+    return copy;
 }
 
 
@@ -844,26 +1056,28 @@ jml_array_concatenate(void)
 {
     jml_obj_array_t        *array   = AS_ARRAY(jml_vm_peek(1));
     jml_value_t             value   = jml_vm_peek(0);
-
-    jml_obj_array_t        *copy    = jml_array_copy(array);
+    jml_obj_array_t        *copy;
 
     if (IS_ARRAY(value)) {
         jml_obj_array_t    *array2  = AS_ARRAY(value);
 
-        if (array == array2) goto end;
+        if (array == array2)
+            copy                    = jml_array_copy(array, 0);
+        else {
+            copy                    = jml_array_copy(
+                array, array2->values.count);
+
+            jml_value_array_extend(&copy->values,
+                array2->values.values, array2->values.count);
+        }
 
-        for (int i = 0; i < array2->values.count; ++i)
-            jml_value_array_write(&copy->values,
-                array2->values.values[i]);
     } else {
+        copy                        = jml_array_copy(array, 1);
         jml_value_array_write(&copy->values, value);
-        goto end;
     }
 
-    end: {
-        jml_vm_pop_two();
-        jml_vm_push(OBJ_VAL(copy));
-    }
+    jml_vm_pop_two();
+    jml_vm_push(OBJ_VAL(copy));
 }
 
 
@@ -913,36 +1127,32 @@ jml_vm_module_bind(jml_obj_module_t *module,
     jml_value_t  function;
     jml_value_t *value;
 
-    if (!jml_hashmap_get(&module->globals, name, &value)) {
-#ifdef JML_LAZY_IMPORT
-        jml_obj_cfunction_t *cfunction = jml_module_get_raw(
-            module, name->chars, true);
+    if (jml_hashmap_get(&module->globals, name, &value))
+        function = *value;
 
-        if (cfunction != NULL) {
-            function = OBJ_VAL(cfunction);
-            jml_vm_push(function);
+    else {
+#ifdef JML_LAZY_IMPORT
+        jml_obj_cfunction_t *cfunction = jml_module_lazy_bind(module, name);
 
-            jml_hashmap_set(&module->globals,
-                name, jml_vm_peek(0));
+        if (cfunction == NULL)
+            goto err;
 
-            jml_vm_pop();
-        }
+        function = OBJ_VAL(cfunction);
 #else
         goto err;
 #endif
-        err: {
-            jml_vm_error(
-                "UndefErr: Undefined member '%.*s'.",
-                (int32_t)name->length, name->chars
-            );
-            return false;
-        }
-    } else
-        function = *value;
+    }
 
     jml_vm_pop();
     jml_vm_push(function);
     return true;
+
+err:
+    jml_vm_error(
+        "UndefErr: Undefined member '%.*s'.",
+        (int32_t)name->length, name->chars
+    );
+    return false;
 }
 
 
@@ -1188,14 +1398,17 @@ jml_vm_run(jml_value_t *last)
         TABLE_OP(OP_LOOP),
         TABLE_OP(OP_CALL),
         TABLE_OP(OP_TRY_CALL),
+        TABLE_OP(OP_TAIL_CALL),
         TABLE_OP(OP_INVOKE),
         TABLE_OP(EXTENDED_OP(OP_INVOKE)),
         TABLE_OP(OP_TRY_INVOKE),
         TABLE_OP(EXTENDED_OP(OP_TRY_INVOKE)),
-        TABLE_OP(OP_SUPER_INVOKE),
-        TABLE_OP(EXTENDED_OP(OP_SUPER_INVOKE)),
+        TABLE_OP(OP_TAIL_INVOKE),
+        TABLE_OP(EXTENDED_OP(OP_TAIL_INVOKE)),
         TABLE_OP(OP_TRY_SUPER_INVOKE),
         TABLE_OP(EXTENDED_OP(OP_TRY_SUPER_INVOKE)),
+        TABLE_OP(OP_SUPER_INVOKE),
+        TABLE_OP(EXTENDED_OP(OP_SUPER_INVOKE)),
         TABLE_OP(OP_CLOSURE),
         TABLE_OP(EXTENDED_OP(OP_CLOSURE)),
         TABLE_OP(OP_RETURN),
@@ -1228,6 +1441,9 @@ jml_vm_run(jml_value_t *last)
         TABLE_OP(EXTENDED_OP(OP_GET_MEMBER)),
         TABLE_OP(OP_SET_INDEX),
         TABLE_OP(OP_GET_INDEX),
+        TABLE_OP(OP_ITER_INIT),
+        TABLE_OP(OP_ITER_NEXT),
+        TABLE_OP(OP_ITER_CHECK),
         TABLE_OP(OP_SWAP_GLOBAL),
         TABLE_OP(EXTENDED_OP(OP_SWAP_GLOBAL)),
         TABLE_OP(OP_SWAP_LOCAL),
@@ -1261,13 +1477,13 @@ jml_vm_run(jml_value_t *last)
 #ifdef JML_COMPUTED_GOTO
     trace_stack: {
 #endif
-        printf("          ");
+        jml_output_printf("          ");
         for (jml_value_t *slot = running->stack; slot < running->stack_top; ++slot) {
-            printf("[ ");
+            jml_output_printf("[ ");
             jml_value_print(*slot);
-            printf(" ]");
+            jml_output_printf(" ]");
         }
-        printf("\n");
+        jml_output_printf("\n");
 
 #ifdef JML_STEP_STACK
         jml_bytecode_instruction_disassemble(&frame->closure->function->bytecode,
@@ -1556,8 +1772,38 @@ jml_vm_run(jml_value_t *last)
 
             EXEC_OP(OP_CALL) {
                 int arg_count       = READ_BYTE();
+                jml_value_t callee  = jml_vm_peek(arg_count);
                 SAVE_FRAME();
-                if (!jml_vm_call_value(running, jml_vm_peek(arg_count), arg_count))
+
+                /*closures called with their exact arity skip the generic path*/
+                jml_obj_closure_t *closure      = NULL;
+
+                if (IS_CLOSURE(callee))
+                    closure = AS_CLOSURE(callee);
+                else if (IS_METHOD(callee))
+                    closure = AS_METHOD(callee)->method;
+
+                if (closure != NULL) {
+                    if (!closure->function->variadic
+                        && closure->function->arity == (uint32_t)arg_count
+                        && running->frame_count < vm->recursion_limit
+                        && running->frame_count + 1 < running->frame_capacity
+                        && running->stack_top + STACK_RESERVE
+                            < running->stack + running->stack_capacity) {
+
+                        if (IS_METHOD(callee))
+                            running->stack_top[-arg_count - 1] = AS_METHOD(callee)->receiver;
+
+                        frame           = &running->frames[running->frame_count++];
+                        frame->closure  = closure;
+                        frame->slots    = running->stack_top - arg_count - 1;
+                        frame->base     = frame->slots;
+                        pc              = closure->function->bytecode.code;
+                        END_OP();
+                    }
+                }
+
+                if (!jml_vm_call_value(running, callee, arg_count))
                     return INTERPRET_RUNTIME_ERROR;
 
                 LOAD_FRAME();
@@ -1566,7 +1812,6 @@ jml_vm_run(jml_value_t *last)
 
             EXEC_OP(OP_TRY_CALL) {
                 int arg_count       = READ_BYTE();
-                ++pc;
 
                 SAVE_FRAME();
                 if (!jml_vm_call_value(running, jml_vm_peek(arg_count), arg_count))
@@ -1576,6 +1821,19 @@ jml_vm_run(jml_value_t *last)
                 END_OP();
             }
 
+            EXEC_OP(OP_TAIL_CALL) {
+                int      arg_count  = READ_BYTE();
+                uint32_t depth      = running->frame_count;
+
+                SAVE_FRAME();
+                if (!jml_vm_call_value(running, jml_vm_peek(arg_count), arg_count))
+                    return INTERPRET_RUNTIME_ERROR;
+
+                jml_vm_call_tail(running, depth);
+                LOAD_FRAME();
+                END_OP();
+            }
+
             EXEC_OP(OP_INVOKE) {
                 jml_obj_string_t *name      = READ_STRING();
                 int               arg_count = READ_BYTE();
@@ -1603,7 +1861,6 @@ jml_vm_run(jml_value_t *last)
             EXEC_OP(OP_TRY_INVOKE) {
                 jml_obj_string_t *name      = READ_STRING();
                 int               arg_count = READ_BYTE();
-                ++pc;
 
                 SAVE_FRAME();
                 if (!jml_vm_invoke(running, name, arg_count))
@@ -1616,7 +1873,6 @@ jml_vm_run(jml_value_t *last)
             EXEC_OP(EXTENDED_OP(OP_TRY_INVOKE)) {
                 jml_obj_string_t *name      = READ_STRING_EXTENDED();
                 int               arg_count = READ_SHORT();
-                ++pc;
 
                 SAVE_FRAME();
                 if (!jml_vm_invoke(running, name, arg_count))
@@ -1626,6 +1882,34 @@ jml_vm_run(jml_value_t *last)
                 END_OP();
             }
 
+            EXEC_OP(OP_TAIL_INVOKE) {
+                jml_obj_string_t *name      = READ_STRING();
+                int               arg_count = READ_BYTE();
+                uint32_t          depth     = running->frame_count;
+
+                SAVE_FRAME();
+                if (!jml_vm_invoke(running, name, arg_count))
+                    return INTERPRET_RUNTIME_ERROR;
+
+                jml_vm_call_tail(running, depth);
+                LOAD_FRAME();
+                END_OP();
+            }
+
+            EXEC_OP(EXTENDED_OP(OP_TAIL_INVOKE)) {
+                jml_obj_string_t *name      = READ_STRING_EXTENDED();
+                int               arg_count = READ_SHORT();
+                uint32_t          depth     = running->frame_count;
+
+                SAVE_FRAME();
+                if (!jml_vm_invoke(running, name, arg_count))
+                    return INTERPRET_RUNTIME_ERROR;
+
+                jml_vm_call_tail(running, depth);
+                LOAD_FRAME();
+                END_OP();
+            }
+
             EXEC_OP(OP_SUPER_INVOKE) {
                 jml_obj_string_t *method    = READ_STRING();
                 int               arg_count = READ_BYTE();
@@ -1665,7 +1949,6 @@ jml_vm_run(jml_value_t *last)
             EXEC_OP(OP_TRY_SUPER_INVOKE) {
                 jml_obj_string_t *method    = READ_STRING();
                 int               arg_count = READ_BYTE();
-                ++pc;
 
                 SAVE_FRAME();
                 jml_obj_class_t *superclass = AS_CLASS(jml_vm_pop());
@@ -1684,7 +1967,6 @@ jml_vm_run(jml_value_t *last)
             EXEC_OP(EXTENDED_OP(OP_TRY_SUPER_INVOKE)) {
                 jml_obj_string_t *method    = READ_STRING_EXTENDED();
                 int               arg_count = READ_SHORT();
-                ++pc;
 
                 SAVE_FRAME();
                 jml_obj_class_t *superclass = AS_CLASS(jml_vm_pop());
@@ -1702,35 +1984,13 @@ jml_vm_run(jml_value_t *last)
 
             EXEC_OP(OP_CLOSURE) {
                 jml_obj_function_t *function = AS_FUNCTION(READ_CONST());
-                jml_obj_closure_t  *closure  = jml_obj_closure_new(function);
-                jml_vm_push(OBJ_VAL(closure));
-
-                for (int i = 0; i < closure->upvalue_count; ++i) {
-                    uint8_t local = READ_BYTE();
-                    uint8_t index = READ_BYTE();
-
-                    if (local)
-                        closure->upvalues[i] = jml_vm_upvalue_capture(running, frame->slots + index);
-                    else
-                        closure->upvalues[i] = frame->closure->upvalues[index];
-                }
+                pc = jml_vm_closure_push(running, frame, function, pc);
                 END_OP();
             }
 
             EXEC_OP(EXTENDED_OP(OP_CLOSURE)) {
                 jml_obj_function_t *function = AS_FUNCTION(READ_CONST_EXTENDED());
-                jml_obj_closure_t  *closure  = jml_obj_closure_new(function);
-                jml_vm_push(OBJ_VAL(closure));
-
-                for (int i = 0; i < closure->upvalue_count; ++i) {
-                    uint8_t local = READ_SHORT();
-                    uint8_t index = READ_SHORT();
-
-                    if (local)
-                        closure->upvalues[i] = jml_vm_upvalue_capture(running, frame->slots + index);
-                    else
-                        closure->upvalues[i] = frame->closure->upvalues[index];
-                }
+                pc = jml_vm_closure_push(running, frame, function, pc);
                 END_OP();
             }
 
@@ -1741,10 +2001,11 @@ jml_vm_run(jml_value_t *last)
 
                 if (running->frame_count == 0) {
                     jml_vm_pop();
+                    jml_vm_push(result);
                     return INTERPRET_OK;
                 }
 
-                running->stack_top = frame->slots;
+                jml_obj_coroutine_seek(running, frame->base);
                 jml_vm_push(result);
 
                 LOAD_FRAME();
@@ -1758,10 +2019,9 @@ jml_vm_run(jml_value_t *last)
                     return INTERPRET_RUNTIME_ERROR;
                 }
 
-                if (!jml_vm_exception(AS_EXCEPTION(jml_vm_peek(0))))
+                if (!jml_vm_exception(AS_EXCEPTION(jml_vm_pop())))
                     return INTERPRET_RUNTIME_ERROR;
 
-                jml_vm_pop();
                 LOAD_FRAME();
                 END_OP();
             }
@@ -1838,11 +2098,11 @@ jml_vm_run(jml_value_t *last)
                 uint8_t slot = READ_BYTE();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(frame->slots[slot]);
-                printf(" ]     ->     [ ");
+                jml_output_printf(" ]     ->     [ ");
                 jml_value_print(jml_vm_peek(0));
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 frame->slots[slot] = jml_vm_peek(0);
                 END_OP();
@@ -1852,11 +2112,11 @@ jml_vm_run(jml_value_t *last)
                 uint16_t slot = READ_SHORT();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(frame->slots[slot]);
-                printf(" ]     ->     [ ");
+                jml_output_printf(" ]     ->     [ ");
                 jml_value_print(jml_vm_peek(0));
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 frame->slots[slot] = jml_vm_peek(0);
                 END_OP();
@@ -1866,9 +2126,9 @@ jml_vm_run(jml_value_t *last)
                 uint8_t slot = READ_BYTE();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(frame->slots[slot]);
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 jml_vm_push(frame->slots[slot]);
                 END_OP();
@@ -1878,9 +2138,9 @@ jml_vm_run(jml_value_t *last)
                 uint16_t slot = READ_SHORT();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(frame->slots[slot]);
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 jml_vm_push(frame->slots[slot]);
                 END_OP();
@@ -1890,15 +2150,15 @@ jml_vm_run(jml_value_t *last)
                 uint8_t slot = READ_BYTE();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 if (frame->closure->upvalues[slot]->location != NULL)
                     jml_value_print(*frame->closure->upvalues[slot]->location);
                 else
-                    printf("(null)");
+                    jml_output_printf("(null)");
 
-                printf(" ]     ->     [ ");
+                jml_output_printf(" ]     ->     [ ");
                 jml_value_print(jml_vm_peek(0));
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 *frame->closure->upvalues[slot]->location = jml_vm_peek(0);
                 END_OP();
@@ -1908,15 +2168,15 @@ jml_vm_run(jml_value_t *last)
                 uint16_t slot = READ_SHORT();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 if (frame->closure->upvalues[slot]->location != NULL)
                     jml_value_print(*frame->closure->upvalues[slot]->location);
                 else
-                    printf("(null)");
+                    jml_output_printf("(null)");
 
-                printf(" ]     ->     [ ");
+                jml_output_printf(" ]     ->     [ ");
                 jml_value_print(jml_vm_peek(0));
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 *frame->closure->upvalues[slot]->location = jml_vm_peek(0);
                 END_OP();
@@ -1926,9 +2186,9 @@ jml_vm_run(jml_value_t *last)
                 uint8_t slot = READ_BYTE();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(*frame->closure->upvalues[slot]->location);
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 jml_vm_push(*frame->closure->upvalues[slot]->location);
                 END_OP();
@@ -1938,9 +2198,9 @@ jml_vm_run(jml_value_t *last)
                 uint16_t slot = READ_SHORT();
 
 #ifdef JML_TRACE_SLOT
-                printf("          (slot %d)     [ ", slot);
+                jml_output_printf("          (slot %d)     [ ", slot);
                 jml_value_print(*frame->closure->upvalues[slot]->location);
-                printf(" ]\n");
+                jml_output_printf(" ]\n");
 #endif
                 jml_vm_push(*frame->closure->upvalues[slot]->location);
                 END_OP();
@@ -2296,6 +2556,40 @@ jml_vm_run(jml_value_t *last)
                     else
                         array.values[num_index]                 = value;
 
+                } else if (IS_BUFFER(box)) {
+                    if (!IS_NUM(index) || !IS_NUM(value)) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: Buffers can be indexed and assigned only by numbers."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    jml_obj_buffer_t *buffer    = AS_BUFFER(box);
+                    int64_t num_index           = AS_NUM(index);
+                    int64_t length              = jml_obj_buffer_count(buffer);
+
+                    if (num_index >= length || num_index < -length) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "RangeErr: Out of bounds assignment to buffer."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    if (buffer->readonly) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: Can't assign to read-only buffer."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    if (num_index < 0)
+                        num_index              += length;
+
+                    jml_obj_buffer_store(buffer, num_index, AS_NUM(value));
+
                 } else if (IS_INSTANCE(box)) {
                     SAVE_FRAME();
                     if (!jml_vm_invoke_instance(running, AS_INSTANCE(box),
@@ -2314,7 +2608,7 @@ jml_vm_run(jml_value_t *last)
                 } else {
                     SAVE_FRAME();
                     RUNTIME_ERROR(
-                        "DiffTypes: Can index only arrays, maps and instances."
+                        "DiffTypes: Can index only arrays, buffers, maps and instances."
                     );
                     return INTERPRET_RUNTIME_ERROR;
                 }
@@ -2364,6 +2658,26 @@ jml_vm_run(jml_value_t *last)
                     else
                         value       = array.values[num_index];
 
+                } else if (IS_BUFFER(box)) {
+                    if (!IS_NUM(index)) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: Buffers can be indexed only by numbers."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    jml_obj_buffer_t *buffer    = AS_BUFFER(box);
+                    int64_t num_index           = AS_NUM(index);
+                    int64_t length              = jml_obj_buffer_count(buffer);
+
+                    if (num_index >= length || num_index < -length)
+                        value       = NONE_VAL;
+                    else if (num_index < 0)
+                        value       = NUM_VAL(jml_obj_buffer_load(buffer, length + num_index));
+                    else
+                        value       = NUM_VAL(jml_obj_buffer_load(buffer, num_index));
+
                 } else if (IS_INSTANCE(box)) {
                     SAVE_FRAME();
                     if (!jml_vm_invoke_instance(running, AS_INSTANCE(box),
@@ -2382,7 +2696,7 @@ jml_vm_run(jml_value_t *last)
                 } else {
                     SAVE_FRAME();
                     RUNTIME_ERROR(
-                        "DiffTypes: Can index only arrays, maps and instances."
+                        "DiffTypes: Can index only arrays, buffers, maps and instances."
                     );
                     return INTERPRET_RUNTIME_ERROR;
                 }
@@ -2392,6 +2706,236 @@ jml_vm_run(jml_value_t *last)
                 END_OP();
             }
 
+            EXEC_OP(OP_ITER_INIT) {
+                jml_value_t         box     = jml_vm_peek(0);
+
+                if (IS_INSTANCE(box)) {
+                    jml_obj_instance_t *instance = AS_INSTANCE(box);
+                    jml_value_t        *temp;
+
+                    /*an instance with only '__next' is its own iterator*/
+                    if (jml_hashmap_get(&instance->klass->statics,
+                        vm->iter_string, &temp)) {
+
+                        SAVE_FRAME();
+                        if (!jml_vm_invoke_instance(running, instance,
+                            vm->iter_string, 0))
+                            return INTERPRET_RUNTIME_ERROR;
+
+                        LOAD_FRAME();
+
+                    } else if (!jml_hashmap_get(&instance->klass->statics,
+                        vm->next_string, &temp)
+                        && !jml_vm_iter_indexed(instance)) {
+
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: Can't iterate instance of '%.*s'.",
+                            (int32_t)instance->klass->name->length,
+                            instance->klass->name->chars
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                } else if (!IS_ARRAY(box) && !IS_MAP(box)
+                    && !IS_STRING(box) && !IS_BUFFER(box)) {
+
+                    SAVE_FRAME();
+                    RUNTIME_ERROR(
+                        "DiffTypes: Can iterate only arrays, buffers, maps, strings and instances."
+                    );
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+
+                END_OP();
+            }
+
+            EXEC_OP(OP_ITER_NEXT) {
+                uint8_t             slot    = READ_BYTE();
+                bool                pair    = READ_BYTE();
+                jml_value_t         box     = frame->slots[slot];
+                jml_value_t        *cursor  = &frame->slots[slot + 1];
+
+                if (IS_INSTANCE(box)) {
+                    jml_obj_instance_t *instance = AS_INSTANCE(box);
+                    jml_obj_string_t   *method   = vm->next_string;
+                    jml_value_t        *temp;
+
+                    /*'__size' and '__get' are the fallback protocol*/
+                    if (!jml_hashmap_get(&instance->klass->statics,
+                        vm->next_string, &temp)) {
+
+                        if (!jml_vm_iter_indexed(instance)) {
+                            SAVE_FRAME();
+                            RUNTIME_ERROR(
+                                "DiffTypes: Can't iterate instance of '%.*s'.",
+                                (int32_t)instance->klass->name->length,
+                                instance->klass->name->chars
+                            );
+                            return INTERPRET_RUNTIME_ERROR;
+                        }
+
+                        method      = vm->size_string;
+
+                    } else
+                        *cursor     = BOOL_VAL(true);
+
+                    /*the flag and the result are taken by OP_ITER_CHECK*/
+                    jml_vm_push(BOOL_VAL(pair));
+                    jml_vm_push(box);
+
+                    SAVE_FRAME();
+                    if (!jml_vm_invoke_instance(running, instance,
+                        method, 0))
+                        return INTERPRET_RUNTIME_ERROR;
+
+                    LOAD_FRAME();
+                    END_OP();
+                }
+
+                uint32_t            index   = AS_NUM(*cursor);
+                jml_value_t         key     = NUM_VAL(index);
+                jml_value_t         value   = NONE_VAL;
+                bool                done    = false;
+
+                if (IS_ARRAY(box)) {
+                    jml_value_array_t *array = &AS_ARRAY(box)->values;
+
+                    if (index >= (uint32_t)array->count)
+                        done        = true;
+                    else
+                        value       = array->values[index++];
+
+                } else if (IS_MAP(box)) {
+                    jml_hashmap_t  *hashmap = &AS_MAP(box)->hashmap;
+
+                    while ((int)index < hashmap->capacity
+                        && hashmap->entries[index].key == NULL)
+                        ++index;
+
+                    if ((int)index >= hashmap->capacity)
+                        done        = true;
+                    else {
+                        key         = OBJ_VAL(hashmap->entries[index].key);
+                        value       = pair ? hashmap->entries[index].value : key;
+                        ++index;
+                    }
+
+                } else if (IS_BUFFER(box)) {
+                    jml_obj_buffer_t *buffer = AS_BUFFER(box);
+
+                    if (index >= jml_obj_buffer_count(buffer))
+                        done        = true;
+                    else
+                        value       = NUM_VAL(jml_obj_buffer_load(buffer, index++));
+
+                } else {
+                    jml_obj_string_t *string = AS_STRING(box);
+
+                    if (index >= string->length)
+                        done        = true;
+                    else {
+                        uint32_t size = jml_string_charbytes(string->chars, index);
+
+                        if (size == 0 || index + size > string->length)
+                            size    = 1;
+
+                        value       = OBJ_VAL(jml_obj_string_copy(
+                            string->chars + index, size));
+                        index      += size;
+                    }
+                }
+
+                if (done) {
+                    *cursor         = NONE_VAL;
+                    jml_vm_push(NONE_VAL);
+                    END_OP();
+                }
+
+                *cursor             = NUM_VAL(index);
+
+                if (pair)
+                    jml_vm_push(key);
+
+                jml_vm_push(value);
+                END_OP();
+            }
+
+            EXEC_OP(OP_ITER_CHECK) {
+                uint8_t             slot    = READ_BYTE();
+                uint16_t            offset  = READ_SHORT();
+                jml_value_t         box     = frame->slots[slot];
+                jml_value_t        *cursor  = &frame->slots[slot + 1];
+
+                if (IS_INSTANCE(box) && IS_NUM(*cursor)) {
+                    jml_value_t     size    = jml_vm_pop();
+                    bool            pair    = AS_BOOL(jml_vm_pop());
+                    double          index   = AS_NUM(*cursor);
+
+                    if (!IS_NUM(size)) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: '__size' must return a number."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    if (index >= AS_NUM(size)) {
+                        pc         += offset;
+                        END_OP();
+                    }
+
+                    *cursor         = NUM_VAL(index + 1);
+
+                    if (pair)
+                        jml_vm_push(NUM_VAL(index));
+
+                    jml_vm_push(box);
+                    jml_vm_push(NUM_VAL(index));
+
+                    SAVE_FRAME();
+                    if (!jml_vm_invoke_instance(running, AS_INSTANCE(box),
+                        vm->get_string, 1))
+                        return INTERPRET_RUNTIME_ERROR;
+
+                    LOAD_FRAME();
+                    END_OP();
+
+                } else if (IS_INSTANCE(box)) {
+                    jml_value_t     value   = jml_vm_pop();
+                    bool            pair    = AS_BOOL(jml_vm_pop());
+
+                    if (IS_NONE(value)) {
+                        pc         += offset;
+                        END_OP();
+                    }
+
+                    if (!pair) {
+                        jml_vm_push(value);
+                        END_OP();
+                    }
+
+                    if (!IS_ARRAY(value) || AS_ARRAY(value)->values.count != 2) {
+                        SAVE_FRAME();
+                        RUNTIME_ERROR(
+                            "DiffTypes: '__next' must return a pair to unpack."
+                        );
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    jml_value_t *values = AS_ARRAY(value)->values.values;
+
+                    jml_vm_push(values[0]);
+                    jml_vm_push(values[1]);
+
+                } else if (IS_NONE(*cursor)) {
+                    jml_vm_pop();
+                    pc             += offset;
+                }
+
+                END_OP();
+            }
+
             EXEC_OP(OP_SWAP_GLOBAL) {
                 jml_value_t module          = READ_CONST();
                 jml_obj_string_t *old_name  = READ_STRING();
@@ -2581,6 +3125,9 @@ jml_vm_run(jml_value_t *last)
                     return INTERPRET_RUNTIME_ERROR;
                 }
 
+#ifdef JML_LAZY_IMPORT
+                jml_module_lazy_bind_all(AS_MODULE(jml_vm_peek(0)));
+#endif
                 jml_vm_global_add(module, &AS_MODULE(jml_vm_peek(0))->globals);
                 jml_vm_pop();
                 LOAD_FRAME();
@@ -2597,6 +3144,9 @@ jml_vm_run(jml_value_t *last)
                     return INTERPRET_RUNTIME_ERROR;
                 }
 
+#ifdef JML_LAZY_IMPORT
+                jml_module_lazy_bind_all(AS_MODULE(jml_vm_peek(0)));
+#endif
                 jml_vm_global_add(module, &AS_MODULE(jml_vm_peek(0))->globals);
                 jml_vm_pop();
                 LOAD_FRAME();
@@ -2660,6 +3210,66 @@ jml_vm_call_coroutine(jml_obj_coroutine_t *coroutine, jml_value_t *last)
 }
 
 
+/*
+ * runs callee to completion on a spare coroutine,
+ * so that cfunctions can call back into the vm
+ */
+bool
+jml_vm_callback(jml_obj_coroutine_t *coroutine, jml_value_t callee,
+    int arg_count, jml_value_t *args, jml_value_t *result)
+{
+    jml_obj_coroutine_t *saved      = vm->running;
+    jml_obj_coroutine_t *outer      = vm->callback;
+
+    /*a stream stage pulling its own pipeline would wipe the running frames*/
+    if (coroutine->caller != NULL) {
+        *result                     = OBJ_VAL(jml_obj_exception_new(
+            "CallErr", "Callback re-entered its coroutine."
+        ));
+        return false;
+    }
+
+    /*each level also recurses on the c stack*/
+    if (vm->callback_depth >= CALLBACK_MAX) {
+        *result                     = OBJ_VAL(jml_obj_exception_new(
+            "OverflowErr", "Callback depth overflow."
+        ));
+        return false;
+    }
+
+    ++vm->callback_depth;
+    jml_obj_coroutine_reset(coroutine);
+    coroutine->caller               = saved;
+    vm->running                     = coroutine;
+    vm->callback                    = coroutine;
+
+    jml_vm_push(callee);
+    for (int i = 0; i < arg_count; ++i)
+        jml_vm_push(args[i]);
+
+    bool success                    = jml_vm_call_value(
+        coroutine, callee, arg_count)
+        && (coroutine->frame_count == 0
+        || jml_vm_run(NULL) == INTERPRET_OK);
+
+    if (success)
+        *result                     = coroutine->stack_top[-1];
+
+    /*runtime errors were already reported and leave none*/
+    else
+        *result                     = vm->raised != NULL
+                                    ? OBJ_VAL(vm->raised) : NONE_VAL;
+
+    vm->raised                      = NULL;
+    vm->callback                    = outer;
+    --vm->callback_depth;
+    vm->running                     = saved;
+    coroutine->caller               = NULL;
+
+    return success;
+}
+
+
 void
 jml_cfunction_register(const char *name,
     jml_cfunction function, jml_obj_module_t *module)
@@ -2767,3 +3377,101 @@ jml_vm_eval(jml_vm_t *_vm, const char *source)
     return NONE_VAL;
 #endif
 }
+
+
+static void
+jml_output_policy(const char *chars, size_t length)
+{
+    switch (vm->output_mode) {
+        case OUTPUT_LINE:
+            if (memchr(chars, '\n', length) != NULL)
+                jml_output_flush();
+            break;
+
+        case OUTPUT_BLOCK:
+            if (vm->output.length >= OUTPUT_MAX)
+                jml_output_flush();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void
+jml_output_write(const char *chars, size_t length)
+{
+    if (vm == NULL) {
+        fwrite(chars, 1, length, stdout);
+        return;
+    }
+
+    jml_strbuf_append(&vm->output, chars, length);
+    jml_output_policy(chars, length);
+}
+
+
+JML_FORMAT(1, 2) void
+jml_output_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if (vm == NULL) {
+        vprintf(format, args);
+        va_end(args);
+        return;
+    }
+
+    size_t start                    = vm->output.length;
+    jml_strbuf_vprintf(&vm->output, format, args);
+    va_end(args);
+
+    jml_output_commit(start);
+}
+
+
+void
+jml_output_commit(size_t start)
+{
+    /*the buffer may have been flushed while writing*/
+    if (start > vm->output.length)
+        start                       = 0;
+
+    jml_output_policy(vm->output.chars + start, vm->output.length - start);
+}
+
+
+void
+jml_output_flush(void)
+{
+    if (vm == NULL || vm->output.chars == NULL)
+        return;
+
+    if (vm->output.length > 0) {
+        fwrite(vm->output.chars, 1, vm->output.length, stdout);
+        vm->output.length           = 0;
+        vm->output.chars[0]         = '\0';
+    }
+
+    fflush(stdout);
+}
+
+
+jml_output_mode
+jml_output_get_mode(void)
+{
+    return vm != NULL ? vm->output_mode : OUTPUT_LINE;
+}
+
+
+void
+jml_output_set_mode(jml_output_mode mode)
+{
+    if (vm == NULL)
+        return;
+
+    jml_output_flush();
+    vm->output_mode                 = mode;
+}
@@ -1,22 +1,12 @@
 #include <jml.h>
 
 
+/*arity and types are checked by the vm, see module_signatures*/
 #define BIT_FUNC2(name, op)                             \
     static jml_value_t                                  \
-    name(int arg_count, jml_value_t *args)              \
+    name(JML_UNUSED(int arg_count), jml_value_t *args)  \
     {                                                   \
-        jml_obj_exception_t *exc = jml_error_args(      \
-            arg_count, 2);                              \
-                                                        \
-        if (exc != NULL)                                \
-            goto err;                                   \
-                                                        \
-        if (!IS_NUM(args[0]) || !IS_NUM(args[1])) {     \
-            exc = jml_error_types(                      \
-                false, 2, "number", "number"            \
-            );                                          \
-            goto err;                                   \
-        }                                               \
+        jml_obj_exception_t *exc;                       \
                                                         \
         double num1 = AS_NUM(args[0]);                  \
         double num2 = AS_NUM(args[1]);                  \
@@ -48,18 +38,9 @@ BIT_FUNC2(jml_std_bit_xor, ^)
 
 
 static jml_value_t
-jml_std_bit_not(int arg_count, jml_value_t *args)
+jml_std_bit_not(JML_UNUSED(int arg_count), jml_value_t *args)
 {
-    jml_obj_exception_t *exc = jml_error_args(
-        arg_count, 1);
-
-    if (exc != NULL)
-        goto err;
-
-    if (!IS_NUM(args[0])) {
-        exc = jml_error_types(false, 1, "number");
-        goto err;
-    }
+    jml_obj_exception_t *exc;
 
     double num = AS_NUM(args[0]);
 
@@ -85,3 +66,14 @@ MODULE_TABLE_HEAD module_table[] = {
     {"_not",                        &jml_std_bit_not},
     {NULL,                          NULL}
 };
+
+
+MODULE_SIGN_HEAD module_signatures[] = {
+    {"lshift",  JML_CFUNC_TYPED,    2,  {JML_PARAM_NUM, JML_PARAM_NUM}},
+    {"rshift",  JML_CFUNC_TYPED,    2,  {JML_PARAM_NUM, JML_PARAM_NUM}},
+    {"_and",    JML_CFUNC_TYPED,    2,  {JML_PARAM_NUM, JML_PARAM_NUM}},
+    {"_or",     JML_CFUNC_TYPED,    2,  {JML_PARAM_NUM, JML_PARAM_NUM}},
+    {"xor",     JML_CFUNC_TYPED,    2,  {JML_PARAM_NUM, JML_PARAM_NUM}},
+    {"_not",    JML_CFUNC_TYPED,    1,  {JML_PARAM_NUM}},
+    {NULL,                          0, 0, {0}}
+};
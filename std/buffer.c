@@ -0,0 +1,413 @@
+#include <string.h>
+
+#include <jml.h>
+
+
+/*compared as doubles, so nan and huge offsets fail*/
+static bool
+jml_std_buffer_range(jml_obj_buffer_t *buffer,
+    double offset, double size)
+{
+    return offset >= 0 && size >= 0
+        && offset + size <= (double)buffer->length;
+}
+
+
+static jml_value_t
+jml_std_buffer_new(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_NUM(args[0])) {
+        exc = jml_error_types(false, 1, "number");
+        goto err;
+    }
+
+    size_t length;
+
+    if (!jml_obj_buffer_size(AS_NUM(args[0]), &length)) {
+        exc = jml_error_value("buffer size");
+        goto err;
+    }
+
+    return OBJ_VAL(jml_obj_buffer_new(length));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_copy(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
+        exc = jml_error_types(false, 1, "string or buffer");
+        goto err;
+    }
+
+    return OBJ_VAL(jml_obj_buffer_copy(bytes, length));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_string(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0])) {
+        exc = jml_error_types(false, 1, "buffer");
+        goto err;
+    }
+
+    jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);
+
+    return OBJ_VAL(jml_obj_string_copy(
+        (const char*)jml_obj_buffer_data(buffer), buffer->length
+    ));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_view(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 3);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0]) || !IS_NUM(args[1]) || !IS_NUM(args[2])) {
+        exc = jml_error_types(false, 3, "buffer", "number", "number");
+        goto err;
+    }
+
+    jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);
+
+    if (!jml_std_buffer_range(buffer, AS_NUM(args[1]), AS_NUM(args[2]))) {
+        exc = jml_obj_exception_new(
+            "RangeErr", "View out of buffer bounds."
+        );
+        goto err;
+    }
+
+    return OBJ_VAL(jml_obj_buffer_view(
+        buffer, AS_NUM(args[1]), AS_NUM(args[2])
+    ));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_resize(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0]) || !IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "buffer", "number");
+        goto err;
+    }
+
+    size_t length;
+
+    if (!jml_obj_buffer_size(AS_NUM(args[1]), &length)) {
+        exc = jml_error_value("buffer size");
+        goto err;
+    }
+
+    if (!jml_obj_buffer_resize(AS_BUFFER(args[0]), length)) {
+        exc = jml_obj_exception_new(
+            "RangeErr", "Can't grow buffer view."
+        );
+        goto err;
+    }
+
+    return NONE_VAL;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_write(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 3);
+
+    if (exc != NULL)
+        goto err;
+
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!IS_BUFFER(args[0]) || !IS_NUM(args[1])
+        || !jml_obj_bytes(args[2], &bytes, &length)) {
+        exc = jml_error_types(false, 3, "buffer", "number", "string or buffer");
+        goto err;
+    }
+
+    jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);
+
+    if (buffer->readonly) {
+        exc = jml_obj_exception_new(
+            "DiffTypes", "Can't write to read-only buffer."
+        );
+        goto err;
+    }
+
+    if (!jml_std_buffer_range(buffer, AS_NUM(args[1]), 0)) {
+        exc = jml_error_value("buffer offset");
+        goto err;
+    }
+
+    size_t offset = AS_NUM(args[1]);
+
+    if (offset + length > buffer->length) {
+        if (!jml_obj_buffer_resize(buffer, offset + length)) {
+            exc = jml_obj_exception_new(
+                "RangeErr", "Write out of buffer view bounds."
+            );
+            goto err;
+        }
+
+        /*the source may be the buffer itself or a view of it*/
+        size_t unused;
+        jml_obj_bytes(args[2], &bytes, &unused);
+    }
+
+    memmove(jml_obj_buffer_data(buffer) + offset, bytes, length);
+    return NUM_VAL(length);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_buffer_fill(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0]) || !IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "buffer", "number");
+        goto err;
+    }
+
+    jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);
+
+    if (buffer->readonly) {
+        exc = jml_obj_exception_new(
+            "DiffTypes", "Can't write to read-only buffer."
+        );
+        goto err;
+    }
+
+    memset(jml_obj_buffer_data(buffer),
+        (uint8_t)jml_obj_number_wrap(AS_NUM(args[1])), buffer->length);
+    return NONE_VAL;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static inline uint64_t
+jml_std_buffer_load(const uint8_t *bytes, size_t size, bool big)
+{
+    uint64_t result = 0;
+
+    for (size_t i = 0; i < size; ++i)
+        result |= (uint64_t)bytes[big ? i : size - 1 - i] << (8 * (size - 1 - i));
+
+    return result;
+}
+
+
+static inline void
+jml_std_buffer_store(uint8_t *bytes, size_t size, bool big, uint64_t value)
+{
+    for (size_t i = 0; i < size; ++i)
+        bytes[big ? size - 1 - i : i] = (uint8_t)(value >> (8 * i));
+}
+
+
+#define BUFFER_READ(name, type, size, big)              \
+    static jml_value_t                                  \
+    name(int arg_count, jml_value_t *args)              \
+    {                                                   \
+        jml_obj_exception_t *exc = jml_error_args(      \
+            arg_count, 2);                              \
+                                                        \
+        if (exc != NULL)                                \
+            goto err;                                   \
+                                                        \
+        if (!IS_BUFFER(args[0]) || !IS_NUM(args[1])) {  \
+            exc = jml_error_types(                      \
+                false, 2, "buffer", "number"            \
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);  \
+                                                        \
+        if (!jml_std_buffer_range(buffer,               \
+            AS_NUM(args[1]), size)) {                   \
+                                                        \
+            exc = jml_obj_exception_new(                \
+                "RangeErr", "Read out of buffer bounds."\
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        uint64_t raw = jml_std_buffer_load(             \
+            jml_obj_buffer_data(buffer)                 \
+            + (size_t)AS_NUM(args[1]), size, big);      \
+                                                        \
+        type value;                                     \
+        if (sizeof(type) == sizeof(uint64_t))           \
+            memcpy(&value, &raw, sizeof(type));         \
+        else                                            \
+            value = (type)raw;                          \
+                                                        \
+        return NUM_VAL(value);                          \
+                                                        \
+    err:                                                \
+        return OBJ_VAL(exc);                            \
+    }
+
+
+#define BUFFER_WRITE(name, type, size, big)             \
+    static jml_value_t                                  \
+    name(int arg_count, jml_value_t *args)              \
+    {                                                   \
+        jml_obj_exception_t *exc = jml_error_args(      \
+            arg_count, 3);                              \
+                                                        \
+        if (exc != NULL)                                \
+            goto err;                                   \
+                                                        \
+        if (!IS_BUFFER(args[0]) || !IS_NUM(args[1])     \
+            || !IS_NUM(args[2])) {                      \
+                                                        \
+            exc = jml_error_types(                      \
+                false, 3, "buffer", "number", "number"  \
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        jml_obj_buffer_t *buffer = AS_BUFFER(args[0]);  \
+                                                        \
+        if (buffer->readonly) {                         \
+            exc = jml_obj_exception_new(                \
+                "DiffTypes",                            \
+                "Can't write to read-only buffer."      \
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        if (!jml_std_buffer_range(buffer,               \
+            AS_NUM(args[1]), size)) {                   \
+                                                        \
+            exc = jml_obj_exception_new(                \
+                "RangeErr", "Write out of buffer bounds."\
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        double value = AS_NUM(args[2]);                 \
+        uint64_t raw = 0;                               \
+        if (sizeof(type) == sizeof(uint64_t))           \
+            memcpy(&raw, &value, sizeof(type));         \
+        else                                            \
+            raw = (uint64_t)jml_obj_number_wrap(value); \
+                                                        \
+        jml_std_buffer_store(                           \
+            jml_obj_buffer_data(buffer)                 \
+            + (size_t)AS_NUM(args[1]), size, big, raw); \
+                                                        \
+        return NONE_VAL;                                \
+                                                        \
+    err:                                                \
+        return OBJ_VAL(exc);                            \
+    }
+
+
+BUFFER_READ(jml_std_buffer_read_u8, uint8_t, 1, false)
+BUFFER_READ(jml_std_buffer_read_u16le, uint16_t, 2, false)
+BUFFER_READ(jml_std_buffer_read_u16be, uint16_t, 2, true)
+BUFFER_READ(jml_std_buffer_read_u32le, uint32_t, 4, false)
+BUFFER_READ(jml_std_buffer_read_u32be, uint32_t, 4, true)
+BUFFER_READ(jml_std_buffer_read_f64le, double, 8, false)
+BUFFER_READ(jml_std_buffer_read_f64be, double, 8, true)
+
+BUFFER_WRITE(jml_std_buffer_write_u8, uint8_t, 1, false)
+BUFFER_WRITE(jml_std_buffer_write_u16le, uint16_t, 2, false)
+BUFFER_WRITE(jml_std_buffer_write_u16be, uint16_t, 2, true)
+BUFFER_WRITE(jml_std_buffer_write_u32le, uint32_t, 4, false)
+BUFFER_WRITE(jml_std_buffer_write_u32be, uint32_t, 4, true)
+BUFFER_WRITE(jml_std_buffer_write_f64le, double, 8, false)
+BUFFER_WRITE(jml_std_buffer_write_f64be, double, 8, true)
+
+
+#undef BUFFER_READ
+#undef BUFFER_WRITE
+
+
+/*module table*/
+MODULE_TABLE_HEAD module_table[] = {
+    {"new",                         &jml_std_buffer_new},
+    {"copy",                        &jml_std_buffer_copy},
+    {"string",                      &jml_std_buffer_string},
+    {"view",                        &jml_std_buffer_view},
+    {"resize",                      &jml_std_buffer_resize},
+    {"write",                       &jml_std_buffer_write},
+    {"fill",                        &jml_std_buffer_fill},
+    {"read_u8",                     &jml_std_buffer_read_u8},
+    {"read_u16le",                  &jml_std_buffer_read_u16le},
+    {"read_u16be",                  &jml_std_buffer_read_u16be},
+    {"read_u32le",                  &jml_std_buffer_read_u32le},
+    {"read_u32be",                  &jml_std_buffer_read_u32be},
+    {"read_f64le",                  &jml_std_buffer_read_f64le},
+    {"read_f64be",                  &jml_std_buffer_read_f64be},
+    {"write_u8",                    &jml_std_buffer_write_u8},
+    {"write_u16le",                 &jml_std_buffer_write_u16le},
+    {"write_u16be",                 &jml_std_buffer_write_u16be},
+    {"write_u32le",                 &jml_std_buffer_write_u32le},
+    {"write_u32be",                 &jml_std_buffer_write_u32be},
+    {"write_f64le",                 &jml_std_buffer_write_f64le},
+    {"write_f64be",                 &jml_std_buffer_write_f64be},
+    {NULL,                          NULL}
+};
@@ -1,3 +1,9 @@
+#ifdef __GNUC__
+
+#define _POSIX_C_SOURCE             200809l
+
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
@@ -9,6 +15,8 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
 
@@ -349,6 +357,8 @@ typedef struct {
     FILE                           *handle;
     jml_file_mode                   mode;
     bool                            open;
+    char                           *buffer;
+    size_t                          buffer_size;
 } jml_std_fs_file_t;
 
 
@@ -362,11 +372,45 @@ jml_std_fs_file_internal_init(const char *name,
     internal->handle            = handle;
     internal->mode              = mode;
     internal->open              = true;
+    internal->buffer            = NULL;
+    internal->buffer_size       = 0;
 
     return internal;
 }
 
 
+static bool
+jml_std_fs_file_readable(jml_std_fs_file_t *internal)
+{
+    switch (internal->mode) {
+        case READ:
+        case READ_WRITE:
+        case WRITE_READ:
+        case APPEND_READ:
+        case READ_BIN:
+        case READ_WRITE_BIN:
+        case WRITE_READ_BIN:
+        case APPEND_READ_BIN:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+static void
+jml_std_fs_file_reserve(jml_std_fs_file_t *internal, size_t size)
+{
+    if (internal->buffer != NULL && internal->buffer_size >= size)
+        return;
+
+    internal->buffer            = jml_realloc(
+        internal->buffer, size > 0 ? size : 1);
+    internal->buffer_size       = size;
+}
+
+
 static jml_value_t
 jml_std_fs_file_init(int arg_count, jml_value_t *args)
 {
@@ -548,6 +592,101 @@ err:
 
 static jml_value_t
 jml_std_fs_file_read(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+
+    if (arg_count - 1 > 1) {
+        exc = jml_error_args(arg_count - 1, 1);
+        goto err;
+    }
+
+    if (arg_count - 1 == 1 && !IS_NUM(args[0])) {
+        exc = jml_error_types(false, 1, "number");
+        goto err;
+    }
+
+    size_t size         = 0;
+
+    if (arg_count - 1 == 1
+        && !jml_obj_buffer_size(AS_NUM(args[0]), &size)) {
+        exc = jml_error_value("read size");
+        goto err;
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[arg_count - 1]);
+    jml_std_fs_file_t  *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("File instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->handle == NULL) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "File instance is closed."
+        );
+        goto err;
+    }
+
+    if (!jml_std_fs_file_readable(internal)) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "File without read permission."
+        );
+        goto err;
+    }
+
+    if (arg_count - 1 == 1) {
+        jml_std_fs_file_reserve(internal, size);
+
+        size_t bytes    = fread(internal->buffer, sizeof(char),
+            size, internal->handle);
+
+        if (bytes < size && ferror(internal->handle)) {
+            exc = jml_obj_exception_new(
+                "FileErr",
+                "Reading File failed."
+            );
+            goto err;
+        }
+
+        if (bytes == 0 && size > 0)
+            return NONE_VAL;
+
+        return OBJ_VAL(jml_obj_string_copy(
+            internal->buffer, bytes));
+    }
+
+    fseek(internal->handle, 0, SEEK_END);
+    size            = ftell(internal->handle);
+    rewind(internal->handle);
+
+    char *buffer    = jml_realloc(NULL, size + 1);
+    size_t bytes    = fread(buffer, sizeof(char),
+        size, internal->handle);
+
+    if (bytes < size) {
+        jml_free(buffer);
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "Reading File failed."
+        );
+        goto err;
+    }
+
+    buffer[bytes] = '\0';
+
+    return OBJ_VAL(jml_obj_string_take(
+        buffer, bytes));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_fs_file_readline(int arg_count, jml_value_t *args)
 {
     jml_obj_exception_t *exc = jml_error_args(
         arg_count - 1, 0);
@@ -571,52 +710,116 @@ jml_std_fs_file_read(int arg_count, jml_value_t *args)
         goto err;
     }
 
-    switch (internal->mode) {
-        case READ:
-        case READ_WRITE:
-        case WRITE_READ:
-        case APPEND_READ:
-        case READ_BIN:
-        case READ_WRITE_BIN:
-        case WRITE_READ_BIN:
-        case APPEND_READ_BIN: {
-            fseek(internal->handle, 0, SEEK_END);
-            size_t size     = ftell(internal->handle);
-            rewind(internal->handle);
-
-            char *buffer    = jml_realloc(NULL, size + 1);
-            size_t bytes    = fread(buffer, sizeof(char),
-                size, internal->handle);
-
-            if (bytes < size) {
-                jml_free(buffer);
-                exc = jml_obj_exception_new(
-                    "FileErr",
-                    "Reading File failed."
-                );
-                goto err;
-            }
-
-            buffer[bytes] = '\0';
+    if (!jml_std_fs_file_readable(internal)) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "File without read permission."
+        );
+        goto err;
+    }
 
-            return OBJ_VAL(jml_obj_string_take(
-                buffer, bytes));
-        }
+    ssize_t length = getline(
+        &internal->buffer, &internal->buffer_size, internal->handle
+    );
 
-        default: {
+    if (length < 0) {
+        if (ferror(internal->handle)) {
             exc = jml_obj_exception_new(
                 "FileErr",
-                "File without read permission."
+                "Reading File failed."
             );
             goto err;
         }
+
+        return NONE_VAL;
+    }
+
+    if (length > 0 && internal->buffer[length - 1] == '\n')
+        --length;
+
+    return OBJ_VAL(jml_obj_string_copy(
+        internal->buffer, length));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_fs_file_read_into(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0])) {
+        exc = jml_error_types(false, 1, "buffer");
+        goto err;
+    }
+
+    jml_obj_instance_t *self   = AS_INSTANCE(args[1]);
+    jml_obj_buffer_t   *buffer = AS_BUFFER(args[0]);
+    jml_std_fs_file_t  *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("File instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->handle == NULL) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "File instance is closed."
+        );
+        goto err;
+    }
+
+    if (!jml_std_fs_file_readable(internal)) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "File without read permission."
+        );
+        goto err;
+    }
+
+    if (buffer->readonly) {
+        exc = jml_error_value("read-only buffer");
+        goto err;
+    }
+
+    size_t bytes = fread(jml_obj_buffer_data(buffer), sizeof(uint8_t),
+        buffer->length, internal->handle);
+
+    if (bytes < buffer->length && ferror(internal->handle)) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "Reading File failed."
+        );
+        goto err;
     }
 
+    return NUM_VAL(bytes);
+
 err:
     return OBJ_VAL(exc);
 }
 
 
+static jml_value_t
+jml_std_fs_file_iter(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 0);
+
+    if (exc != NULL)
+        return OBJ_VAL(exc);
+
+    return args[0];
+}
+
+
 static jml_value_t
 jml_std_fs_file_write(int arg_count, jml_value_t *args)
 {
@@ -626,13 +829,15 @@ jml_std_fs_file_write(int arg_count, jml_value_t *args)
     if (exc != NULL)
         goto err;
 
-    if (!IS_STRING(args[0])) {
-        exc = jml_error_types(false, 1, "string");
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
+        exc = jml_error_types(false, 1, "string or buffer");
         goto err;
     }
 
     jml_obj_instance_t *self = AS_INSTANCE(args[1]);
-    jml_obj_string_t   *string = AS_STRING(args[0]);
     jml_std_fs_file_t  *internal;
 
     if ((internal = self->extra) == NULL) {
@@ -659,10 +864,8 @@ jml_std_fs_file_write(int arg_count, jml_value_t *args)
         case WRITE_READ_BIN:
         case APPEND_BIN:
         case APPEND_READ_BIN: {
-            size_t bytes = fwrite(string->chars,
-                string->length, 1, internal->handle);
-
-            if (bytes != 1) {
+            if (length > 0
+                && fwrite(bytes, length, 1, internal->handle) != 1) {
                 exc = jml_obj_exception_new(
                     "FileErr",
                     "Writing to File failed."
@@ -733,8 +936,13 @@ jml_std_fs_file_free(int arg_count, jml_value_t *args)
     jml_obj_instance_t *self = AS_INSTANCE(args[arg_count - 1]);
 
     if (self->extra != NULL) {
-        jml_std_fs_file_close(1, &args[arg_count - 1]);
-        jml_free(self->extra);
+        jml_std_fs_file_t *internal = self->extra;
+
+        if (internal->open)
+            jml_std_fs_file_close(1, &args[arg_count - 1]);
+
+        jml_free(internal->buffer);
+        jml_free(internal);
         self->extra = NULL;
     }
 
@@ -748,8 +956,12 @@ MODULE_TABLE_HEAD file_table[] = {
     {"open",                        &jml_std_fs_file_open},
     {"close",                       &jml_std_fs_file_close},
     {"read",                        &jml_std_fs_file_read},
+    {"readline",                    &jml_std_fs_file_readline},
+    {"read_into",                   &jml_std_fs_file_read_into},
     {"write",                       &jml_std_fs_file_write},
     {"flush",                       &jml_std_fs_file_flush},
+    {"__iter",                      &jml_std_fs_file_iter},
+    {"__next",                      &jml_std_fs_file_readline},
     {"__free",                      &jml_std_fs_file_free},
     {NULL,                          NULL}
 };
@@ -925,6 +1137,73 @@ err:
 }
 
 
+static void
+jml_std_fs_munmap(uint8_t *bytes, size_t length)
+{
+    if (bytes != NULL)
+        munmap(bytes, length);
+}
+
+
+static jml_value_t
+jml_std_fs_mmap(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_STRING(args[0])) {
+        exc = jml_error_types(false, 1, "string");
+        goto err;
+    }
+
+    int fd = open(AS_CSTRING(args[0]), O_RDONLY);
+
+    if (fd == -1) {
+        exc = jml_obj_exception_new(
+            "FileErr",
+            "Opening File failed."
+        );
+        goto err;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        exc = jml_obj_exception_new(
+            "SystemErr",
+            "Call to 'fstat' failed."
+        );
+        goto err;
+    }
+
+    /*empty files can't be mapped*/
+    if (st.st_size == 0) {
+        close(fd);
+        return OBJ_VAL(jml_obj_buffer_wrap(NULL, 0, &jml_std_fs_munmap));
+    }
+
+    size_t length = (size_t)st.st_size;
+    void *bytes = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (bytes == MAP_FAILED) {
+        exc = jml_obj_exception_new(
+            "SystemErr",
+            "Call to 'mmap' failed."
+        );
+        goto err;
+    }
+
+    return OBJ_VAL(jml_obj_buffer_wrap(bytes, length, &jml_std_fs_munmap));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
 /*module table*/
 MODULE_TABLE_HEAD module_table[] = {
     {"remove",                      &jml_std_fs_remove},
@@ -932,6 +1211,7 @@ MODULE_TABLE_HEAD module_table[] = {
     {"tempfile",                    &jml_std_fs_tempfile},
     {"tempname",                    &jml_std_fs_tempname},
     {"makedir",                     &jml_std_fs_makedir},
+    {"mmap",                        &jml_std_fs_mmap},
     {NULL,                          NULL}
 };
 
@@ -176,13 +176,16 @@ hash_crc32b(const uint8_t *octects, uint32_t len)
         if (exc != NULL)                                \
             goto err;                                   \
                                                         \
-        if (!IS_STRING(args[0])) {                      \
-            exc = jml_error_types(false, 1, "string");  \
+        const uint8_t *bytes;                           \
+        size_t         length;                          \
+                                                        \
+        if (!jml_obj_bytes(args[0], &bytes, &length)) { \
+            exc = jml_error_types(                      \
+                false, 1, "string or buffer"            \
+            );                                          \
             goto err;                                   \
         }                                               \
-        jml_obj_string_t *string = AS_STRING(args[0]);  \
-        uint8_t *bytes = (uint8_t*)string->chars;       \
-        return NUM_VAL(func(bytes, string->length));    \
+        return NUM_VAL(func(bytes, length));            \
                                                         \
     err:                                                \
         return OBJ_VAL(exc);                            \
@@ -1,10 +1,124 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 
 #include <jml.h>
 #include <jml/jml_gc.h>
 
 
+#if defined __GNUC__ && defined __AVX2__
+
+#include <immintrin.h>
+
+#define JML_JSON_BLOCK              32
+
+typedef __m256i jml_json_block_t;
+
+#define BLOCK_LOAD(src)             _mm256_loadu_si256((const __m256i*)(src))
+#define BLOCK_MASK(block)           ((uint32_t)_mm256_movemask_epi8(block))
+#define BLOCK_EQ(block, c)          \
+    BLOCK_MASK(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c)))
+#define BLOCK_CTL(block)            \
+    BLOCK_MASK(_mm256_cmpeq_epi8(                               \
+        _mm256_max_epu8(block, _mm256_set1_epi8(0x1f)),         \
+        _mm256_set1_epi8(0x1f)))
+
+#elif defined __GNUC__ && defined __SSE2__
+
+#include <emmintrin.h>
+
+#define JML_JSON_BLOCK              16
+
+typedef __m128i jml_json_block_t;
+
+#define BLOCK_LOAD(src)             _mm_loadu_si128((const __m128i*)(src))
+#define BLOCK_MASK(block)           ((uint32_t)_mm_movemask_epi8(block))
+#define BLOCK_EQ(block, c)          \
+    BLOCK_MASK(_mm_cmpeq_epi8(block, _mm_set1_epi8(c)))
+#define BLOCK_CTL(block)            \
+    BLOCK_MASK(_mm_cmpeq_epi8(                                  \
+        _mm_max_epu8(block, _mm_set1_epi8(0x1f)),               \
+        _mm_set1_epi8(0x1f)))
+
+#endif
+
+
+/*scanner*/
+static inline size_t
+jml_json_plain_size(const char *src, size_t size, char quote)
+{
+    size_t offset = 0;
+
+#ifdef JML_JSON_BLOCK
+    while (offset + JML_JSON_BLOCK <= size) {
+        jml_json_block_t block = BLOCK_LOAD(src + offset);
+
+        uint32_t mask = BLOCK_EQ(block, quote) | BLOCK_EQ(block, '\\')
+            | BLOCK_CTL(block);
+
+        if (mask != 0)
+            return offset + __builtin_ctz(mask);
+
+        offset += JML_JSON_BLOCK;
+    }
+#endif
+
+    while (offset < size && src[offset] != quote && src[offset] != '\\'
+        && (unsigned char)src[offset] >= 0x20)
+        ++offset;
+
+    return offset;
+}
+
+
+static inline bool
+jml_json_is_structural(char c)
+{
+    switch (c) {
+        case '"':
+        case '\'':
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case '/':
+        case '\n':
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+static inline size_t
+jml_json_structural_size(const char *src, size_t size)
+{
+    size_t offset = 0;
+
+#ifdef JML_JSON_BLOCK
+    while (offset + JML_JSON_BLOCK <= size) {
+        jml_json_block_t block = BLOCK_LOAD(src + offset);
+
+        uint32_t mask = BLOCK_EQ(block, '"') | BLOCK_EQ(block, '\'')
+            | BLOCK_EQ(block, '{') | BLOCK_EQ(block, '}')
+            | BLOCK_EQ(block, '[') | BLOCK_EQ(block, ']')
+            | BLOCK_EQ(block, '/') | BLOCK_EQ(block, '\n');
+
+        if (mask != 0)
+            return offset + __builtin_ctz(mask);
+
+        offset += JML_JSON_BLOCK;
+    }
+#endif
+
+    while (offset < size && !jml_json_is_structural(src[offset]))
+        ++offset;
+
+    return offset;
+}
+
+
 /*parser*/
 typedef enum {
     ALLOW_TRAILING_COMMA = 0x01,
@@ -119,7 +233,35 @@ jml_json_skip_whitespace(jml_json_parser_t *parser)
             return false;
     }
 
-    do {
+#ifdef JML_JSON_BLOCK
+    while (offset + JML_JSON_BLOCK <= size) {
+        jml_json_block_t block = BLOCK_LOAD(src + offset);
+
+        uint32_t lines = BLOCK_EQ(block, '\n');
+        uint32_t space = BLOCK_EQ(block, ' ') | BLOCK_EQ(block, '\r')
+            | BLOCK_EQ(block, '\t') | lines;
+
+        size_t run = ~space != 0 ? (size_t)__builtin_ctz(~space)
+            : JML_JSON_BLOCK;
+
+        if (run < 32)
+            lines &= ((uint32_t)1 << run) - 1;
+
+        if (lines != 0) {
+            parser->line_no += __builtin_popcount(lines);
+            parser->line_off = offset + 31 - __builtin_clz(lines);
+        }
+
+        offset += run;
+
+        if (run < JML_JSON_BLOCK) {
+            parser->off = offset;
+            return true;
+        }
+    }
+#endif
+
+    while (offset < size) {
         switch (src[offset]) {
             case ' ':
             case '\r':
@@ -137,7 +279,7 @@ jml_json_skip_whitespace(jml_json_parser_t *parser)
         }
 
         ++offset;
-    } while (offset < size);
+    }
 
     parser->off = offset;
     return true;
@@ -262,6 +404,15 @@ jml_json_string_size(jml_json_parser_t *parser)
     ++offset;
 
     while ((offset < size) && (src[offset] != closing_quote)) {
+        size_t plain = jml_json_plain_size(
+            src + offset, size - offset, closing_quote);
+
+        if (plain > 0) {
+            data_size += plain;
+            offset += plain;
+            continue;
+        }
+
         ++data_size;
 
         switch (src[offset]) {
@@ -832,6 +983,16 @@ jml_json_string_parse(jml_json_parser_t *parser)
 
     ++offset;
     while (quote_to_use != src[offset]) {
+        size_t plain = jml_json_plain_size(
+            src + offset, parser->size - offset, quote_to_use);
+
+        if (plain > 0) {
+            memcpy(data + bytes_written, src + offset, plain);
+            bytes_written += plain;
+            offset += plain;
+            continue;
+        }
+
         if ('\\' == src[offset]) {
             ++offset;
 
@@ -1269,202 +1430,1090 @@ jml_json_parse(const char *src, size_t size, jml_json_mode flags,
 }
 
 
-static bool
-jml_json_value_unparse(char *buffer, size_t *size,
-    size_t *pos, jml_value_t value)
+/*stream*/
+typedef enum {
+    COMMENT_NONE,
+    COMMENT_LINE,
+    COMMENT_BLOCK
+} jml_json_comment;
+
+
+typedef struct {
+    jml_json_mode                   flags;
+    bool                            lines;
+    char                           *buffer;
+    size_t                          size;
+    size_t                          capacity;
+    size_t                          start;
+    size_t                          scan;
+    size_t                          consumed;
+    size_t                          depth;
+    char                            quote;
+    bool                            escape;
+    bool                            scalar;
+    jml_json_comment                comment;
+    size_t                          line_no;
+    size_t                          start_line;
+    jml_json_error_t                pending;
+} jml_json_stream_t;
+
+
+static jml_json_stream_t *
+jml_json_stream_init(jml_json_mode flags, bool lines)
 {
-    if (IS_OBJ(value)) {
-        switch (OBJ_TYPE(value)) {
-            case OBJ_STRING: {
-                jml_obj_string_t *string = AS_STRING(value);
-                REALLOC(char, buffer, *size, *pos + string->length + 2);
-                *pos += sprintf(buffer + *pos, "\"");
+    jml_json_stream_t *stream   = jml_alloc(sizeof(jml_json_stream_t));
+
+    /*a global object can't be delimited*/
+    stream->flags               = flags & ~ALLOW_GLOBAL;
+    stream->lines               = lines;
+    stream->buffer              = NULL;
+    stream->size                = 0;
+    stream->capacity            = 0;
+    stream->start               = 0;
+    stream->scan                = 0;
+    stream->consumed            = 0;
+    stream->depth               = 0;
+    stream->quote               = '\0';
+    stream->escape              = false;
+    stream->scalar              = false;
+    stream->comment             = COMMENT_NONE;
+    stream->line_no             = 1;
+    stream->start_line          = 1;
+    stream->pending.error       = ERROR_NONE;
+
+    return stream;
+}
+
+
+static void
+jml_json_stream_append(jml_json_stream_t *stream,
+    const char *bytes, size_t length)
+{
+    /*drop the bytes of the values already returned*/
+    if (stream->start > 0) {
+        memmove(stream->buffer, stream->buffer + stream->start,
+            stream->size - stream->start);
+
+        stream->size           -= stream->start;
+        stream->scan           -= stream->start;
+        stream->consumed       += stream->start;
+        stream->start           = 0;
+    }
 
-                memcpy(buffer + *pos, string->chars, string->length);
-                *pos += string->length;
+    /*the parser may peek one byte past the end*/
+    if (stream->size + length + 1 > stream->capacity) {
+        size_t capacity         = stream->capacity < 64
+                                ? 64 : stream->capacity;
 
-                *pos += sprintf(buffer + *pos, "\"");
+        while (capacity < stream->size + length + 1)
+            capacity           *= 2;
+
+        stream->buffer          = jml_realloc(stream->buffer, capacity);
+        stream->capacity        = capacity;
+    }
+
+    memcpy(stream->buffer + stream->size, bytes, length);
+    stream->size               += length;
+    stream->buffer[stream->size] = '\0';
+}
+
+
+static bool
+jml_json_stream_blank(const char *src, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        switch (src[i]) {
+            case ' ':
+            case '\r':
+            case '\t':
+            case '\n':
                 break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*finds the end of the next top-level value*/
+static bool
+jml_json_stream_scan(jml_json_stream_t *stream, size_t *end)
+{
+    const char *src = stream->buffer;
+    const size_t size = stream->size;
+    size_t offset = stream->scan;
+
+    if (stream->lines) {
+        while (offset < size) {
+            const char *newline = memchr(src + offset, '\n', size - offset);
+
+            if (newline == NULL) {
+                stream->scan = size;
+                return false;
             }
 
-            case OBJ_ARRAY: {
-                jml_obj_array_t *array = AS_ARRAY(value);
-                REALLOC(char, buffer, *size, *pos + 2);
-                *pos += sprintf(buffer + *pos, "[");
+            offset = newline - src + 1;
+            ++stream->line_no;
 
-                for (int i = 0; i < (array->values.count - 1); ++i) {
-                    jml_json_value_unparse(buffer, size, pos,
-                        array->values.values[i]);
+            if (jml_json_stream_blank(src + stream->start,
+                offset - stream->start)) {
+                stream->start = offset;
+                stream->start_line = stream->line_no;
+                continue;
+            }
 
-                    REALLOC(char, buffer, *size, *pos + 2);
-                    *pos += sprintf(buffer + *pos, ", ");
-                }
+            *end = offset;
+            stream->scan = offset;
+            return true;
+        }
+
+        stream->scan = offset;
+        return false;
+    }
 
-                jml_json_value_unparse(
-                    buffer, size, pos,
-                    array->values.values[array->values.count - 1]
-                );
+    for (; offset < size; ++offset) {
+        if (stream->comment == COMMENT_NONE && !stream->scalar) {
+            if (stream->quote != '\0' && !stream->escape)
+                offset += jml_json_plain_size(
+                    src + offset, size - offset, stream->quote);
+            else if (stream->quote == '\0' && stream->depth > 0)
+                offset += jml_json_structural_size(
+                    src + offset, size - offset);
 
-                REALLOC(char, buffer, *size, *pos + 2);
-                *pos += sprintf(buffer + *pos, "]");
+            if (offset == size)
                 break;
+        }
+
+        char c = src[offset];
+
+        if (c == '\n')
+            ++stream->line_no;
+
+        if (stream->comment == COMMENT_LINE) {
+            if (c == '\n') {
+                stream->comment = COMMENT_NONE;
+
+                if (stream->depth == 0) {
+                    stream->start = offset + 1;
+                    stream->start_line = stream->line_no;
+                }
             }
+            continue;
 
-            case OBJ_MAP: {
-                jml_obj_map_t *map = AS_MAP(value);
-                jml_hashmap_entry_t *entries = jml_hashmap_iterator(&map->hashmap);
-                REALLOC(char, buffer, *size, *pos + 2);
-                *pos += sprintf(buffer + *pos, "{");
+        } else if (stream->comment == COMMENT_BLOCK) {
+            if (c == '*') {
+                if (offset + 1 == size)
+                    break;
+
+                if (src[offset + 1] == '/') {
+                    stream->comment = COMMENT_NONE;
+                    ++offset;
 
-                for (int i = 0; i < (map->hashmap.count - 1); ++i) {
-                    jml_json_value_unparse(buffer, size, pos,
-                        OBJ_VAL(entries[i].key));
+                    if (stream->depth == 0)
+                        stream->start = offset + 1;
+                }
+            }
+            continue;
+        }
 
-                    REALLOC(char, buffer, *size, *pos + 2);
-                    *pos += sprintf(buffer + *pos, ": ");
+        if (stream->quote != '\0') {
+            if (stream->escape)
+                stream->escape = false;
+            else if (c == '\\')
+                stream->escape = true;
+            else if (c == stream->quote) {
+                stream->quote = '\0';
+
+                if (stream->depth == 0) {
+                    *end = offset + 1;
+                    stream->scan = offset + 1;
+                    return true;
+                }
+            }
+            continue;
+        }
 
-                    jml_json_value_unparse(buffer, size, pos,
-                        entries[i].value);
+        switch (c) {
+            case ' ':
+            case '\r':
+            case '\t':
+            case '\n':
+                /*the terminator is consumed so a newline counts once*/
+                if (stream->scalar) {
+                    stream->scalar = false;
+                    *end = offset + 1;
+                    stream->scan = offset + 1;
+                    return true;
+                }
 
-                    REALLOC(char, buffer, *size, *pos + 2);
-                    *pos += sprintf(buffer + *pos, ", ");
+                if (stream->depth == 0) {
+                    stream->start = offset + 1;
+                    stream->start_line = stream->line_no;
                 }
+                break;
 
-                jml_json_value_unparse(buffer, size, pos,
-                    OBJ_VAL(entries[map->hashmap.count - 1].key));
+            case '/':
+                if (!(stream->flags & ALLOW_COMMENTS))
+                    goto scalar;
 
-                REALLOC(char, buffer, *size, *pos + 2);
-                *pos += sprintf(buffer + *pos, ": ");
+                if (offset + 1 == size) {
+                    stream->scan = offset;
+                    return false;
+                }
 
-                jml_json_value_unparse(buffer, size, pos,
-                    entries[map->hashmap.count - 1].value);
+                if (src[offset + 1] != '/' && src[offset + 1] != '*')
+                    goto scalar;
+
+                if (stream->scalar) {
+                    stream->scalar = false;
+                    *end = offset;
+                    stream->scan = offset;
+                    return true;
+                }
 
-                jml_realloc(entries, 0);
-                REALLOC(char, buffer, *size, *pos + 2);
-                *pos += sprintf(buffer + *pos, "}");
+                stream->comment = src[offset + 1] == '/'
+                    ? COMMENT_LINE : COMMENT_BLOCK;
+                ++offset;
                 break;
-            }
 
-            default:
-                return false;
-        }
-    } else if (IS_NONE(value)) {
-        REALLOC(char, buffer, *size, *pos + 5);
-        *pos += sprintf(buffer + *pos, "null");
+            case '\'':
+                if (!(stream->flags & ALLOW_SINGLE_QUOTED))
+                    goto scalar;
+                /*fallthrough*/
 
-    } else if (IS_BOOL(value)) {
-        REALLOC(char, buffer, *size, *pos + 5);
-        *pos += sprintf(buffer + *pos, BOOL_VAL(value) ? "true" : "false");
+            case '"':
+                if (stream->scalar)
+                    goto scalar;
 
-    } else if (IS_NUM(value)) {
-        char numbuf[64];
-        int numlen = snprintf(numbuf, 64, "%g", AS_NUM(value));
-        REALLOC(char, buffer, *size, *pos + numlen);
-        *pos += sprintf(buffer + *pos, "%.*s", numlen, numbuf);
-    }
+                stream->quote = c;
+                break;
 
-    return true;
-}
+            case '{':
+            case '[':
+                if (stream->scalar)
+                    goto scalar;
 
+                ++stream->depth;
+                break;
 
-static jml_value_t
-jml_std_json_parse(int arg_count, jml_value_t *args)
-{
-    jml_obj_exception_t *exc = jml_error_args(
-        arg_count, 2);
+            case '}':
+            case ']':
+                if (stream->depth == 0 || stream->scalar)
+                    goto scalar;
 
-    if (exc != NULL)
-        goto err;
+                if (--stream->depth == 0) {
+                    *end = offset + 1;
+                    stream->scan = offset + 1;
+                    return true;
+                }
+                break;
 
-    if (!IS_STRING(args[0]) || !IS_NUM(args[1])) {
-        exc = jml_error_types(false, 2, "string", "number");
-        goto err;
+            default:
+            scalar:
+                if (stream->depth == 0)
+                    stream->scalar = true;
+                break;
+        }
     }
 
-    double mode = AS_NUM(args[1]);
-    if (mode != MODE_STRICT && mode != MODE_LENIENT && mode != MODE_JSON5) {
-        exc = jml_error_value("parsing mode");
-        goto err;
-    }
+    stream->scan = offset;
+    return false;
+}
 
-    jml_obj_string_t *string = AS_STRING(args[0]);
-    jml_value_t value;
+
+static jml_json_error_t
+jml_json_stream_parse(jml_json_stream_t *stream, size_t end,
+    jml_value_t *value)
+{
+    const size_t start = stream->start;
 
     jml_json_error_t error = jml_json_parse(
-        string->chars, string->length, (jml_json_mode)mode, &value
+        stream->buffer + start, end - start, stream->flags, value
     );
 
     if (error.error != ERROR_NONE) {
-        const char *errors[] = {
-            "Expected closing bracket or comma",
-            "Expected colon",
-            "Expected quote",
-            "Invalid string escape sequence",
-            "Invalid number",
-            "Invalid value",
-            "Invalid string",
-            "Unexpected eof",
-            "Unexpected trailing characters",
-            "Unknown error"
-        };
-
-        exc = jml_obj_exception_format(
-            "JsonErr", "%s on line %u column %u (char %u).",
-            errors[error.error - 1],
-            error.line_no, error.col_no, error.off
-        );
-        goto err;
+        error.line_no += stream->start_line - 1;
+        error.off += stream->consumed + start;
     }
 
-    return value;
+    /*the bad value is dropped all the same*/
+    stream->start = end;
+    stream->start_line = stream->line_no;
+    return error;
+}
 
-err:
-    return OBJ_VAL(exc);
+
+static void
+jml_json_stream_free(jml_json_stream_t *stream)
+{
+    jml_free(stream->buffer);
+    jml_free(stream);
 }
 
 
-static jml_value_t
-jml_std_json_unparse(int arg_count, jml_value_t *args)
+/*serializer*/
+#define JSON_DEPTH_MAX              512
+
+
+/*
+ * a writer either owns a heap block or writes
+ * straight into the bytes of a destination buffer
+ */
+typedef struct {
+    char                           *data;
+    size_t                          size;
+    size_t                          capacity;
+    size_t                          indent;
+    size_t                          depth;
+    jml_obj_buffer_t               *buffer;
+    bool                            compact;
+    bool                            failed;
+} jml_json_writer_t;
+
+
+static bool
+jml_json_writer_grow(jml_json_writer_t *writer, size_t size)
 {
-    jml_obj_exception_t *exc = jml_error_args(
-        arg_count, 1);
+    jml_obj_buffer_t *buffer = writer->buffer;
 
-    if (exc != NULL)
-        return OBJ_VAL(exc);
+    /*bytes written so far are kept by the resize*/
+    buffer->length = writer->size;
 
-    if (!IS_MAP(args[0])) {
-        exc = jml_error_types(false, 1, "map");
-        return OBJ_VAL(exc);
-    }
+    if (!jml_obj_buffer_resize(buffer, writer->size + size))
+        return false;
 
-    size_t size = 64;
-    size_t pos = 0;
-    char *buffer = jml_realloc(NULL, size);
+    writer->data = (char*)jml_obj_buffer_data(buffer);
+    writer->capacity = buffer->capacity;
+    return true;
+}
 
-    if (!jml_json_value_unparse(buffer, &size, &pos, args[0])) {
-        jml_realloc(buffer, 0);
-        exc = jml_obj_exception_new(
-            "JsonErr", "Invalid value to unparse."
-        );
-        return OBJ_VAL(exc);
+
+static inline bool
+jml_json_writer_reserve(jml_json_writer_t *writer, size_t size)
+{
+    if (writer->size + size <= writer->capacity)
+        return true;
+
+    if (writer->failed)
+        return false;
+
+    if (writer->buffer != NULL)
+        return jml_json_writer_grow(writer, size);
+
+    size_t capacity = writer->capacity < 64 ? 64 : writer->capacity;
+
+    while (capacity < writer->size + size)
+        capacity *= 2;
+
+    writer->data = jml_realloc(writer->data, capacity);
+    writer->capacity = capacity;
+    return true;
+}
+
+
+static inline void
+jml_json_write(jml_json_writer_t *writer, const char *bytes, size_t size)
+{
+    if (!jml_json_writer_reserve(writer, size)) {
+        writer->failed = true;
+        return;
     }
 
-    return OBJ_VAL(jml_obj_string_take(buffer, size));
+    memcpy(writer->data + writer->size, bytes, size);
+    writer->size += size;
 }
 
 
-/*module table*/
-MODULE_TABLE_HEAD module_table[] = {
-    {"parse",                       &jml_std_json_parse},
-    {"unparse",                     &jml_std_json_unparse},
-    {NULL,                          NULL}
-};
+static inline void
+jml_json_write_char(jml_json_writer_t *writer, char c)
+{
+    if (!jml_json_writer_reserve(writer, 1)) {
+        writer->failed = true;
+        return;
+    }
+
+    writer->data[writer->size++] = c;
+}
 
 
-MODULE_FUNC_HEAD
-module_init(jml_obj_module_t *module)
+/*single line output keeps a space after separators unless compact*/
+static void
+jml_json_write_newline(jml_json_writer_t *writer, bool first)
 {
-    jml_module_add_value(module, "MODE_STRICT",  NUM_VAL(MODE_STRICT));
+    if (writer->indent == 0) {
+        if (!first && !writer->compact)
+            jml_json_write_char(writer, ' ');
+        return;
+    }
+
+    size_t spaces = writer->indent * writer->depth;
+
+    if (!jml_json_writer_reserve(writer, spaces + 1)) {
+        writer->failed = true;
+        return;
+    }
+
+    writer->data[writer->size++] = '\n';
+
+    memset(writer->data + writer->size, ' ', spaces);
+    writer->size += spaces;
+}
+
+
+static size_t
+jml_json_escape(char *data, unsigned char c)
+{
+    const char hex[] = "0123456789abcdef";
+    size_t pos = 0;
+
+    data[pos++] = '\\';
+
+    switch (c) {
+        case '"':   data[pos++] = '"';  break;
+        case '\\':  data[pos++] = '\\'; break;
+        case '\b':  data[pos++] = 'b';  break;
+        case '\f':  data[pos++] = 'f';  break;
+        case '\n':  data[pos++] = 'n';  break;
+        case '\r':  data[pos++] = 'r';  break;
+        case '\t':  data[pos++] = 't';  break;
+
+        default:
+            data[pos++] = 'u';
+            data[pos++] = '0';
+            data[pos++] = '0';
+            data[pos++] = hex[c >> 4];
+            data[pos++] = hex[c & 0xf];
+            break;
+    }
+
+    return pos;
+}
+
+
+/*views can't grow, so only the bytes really written are reserved*/
+static void
+jml_json_write_string_bounded(jml_json_writer_t *writer,
+    const char *chars, size_t length)
+{
+    jml_json_write_char(writer, '"');
+
+    size_t offset = 0;
+    while (offset < length) {
+        size_t plain = jml_json_plain_size(
+            chars + offset, length - offset, '"');
+
+        jml_json_write(writer, chars + offset, plain);
+        offset += plain;
+
+        if (offset == length)
+            break;
+
+        char escape[6];
+        jml_json_write(writer, escape,
+            jml_json_escape(escape, chars[offset++]));
+    }
+
+    jml_json_write_char(writer, '"');
+}
+
+
+static void
+jml_json_write_string(jml_json_writer_t *writer,
+    const char *chars, size_t length)
+{
+    /*worst case every byte is escaped as \u00XX*/
+    if (!jml_json_writer_reserve(writer, length * 6 + 2)) {
+        jml_json_write_string_bounded(writer, chars, length);
+        return;
+    }
+
+    char *data = writer->data + writer->size;
+    size_t pos = 0;
+
+    data[pos++] = '"';
+
+    size_t offset = 0;
+    while (offset < length) {
+        size_t plain = jml_json_plain_size(
+            chars + offset, length - offset, '"');
+
+        memcpy(data + pos, chars + offset, plain);
+        pos += plain;
+        offset += plain;
+
+        if (offset == length)
+            break;
+
+        pos += jml_json_escape(data + pos, chars[offset++]);
+    }
+
+    data[pos++] = '"';
+    writer->size += pos;
+}
+
+
+static void
+jml_json_write_number(jml_json_writer_t *writer, double num)
+{
+    char numbuf[32];
+    int numlen;
+
+    if (isnan(num) || isinf(num)) {
+        /*JSON has no representation for inf and nan*/
+        jml_json_write(writer, "null", 4);
+        return;
+    }
+
+    if (num > -9007199254740992.0 && num < 9007199254740992.0
+        && num == (double)(int64_t)num && !(num == 0 && signbit(num))) {
+
+        int64_t integer = (int64_t)num;
+        uint64_t digits = integer < 0 ? -(uint64_t)integer : (uint64_t)integer;
+
+        numlen = sizeof(numbuf);
+        do {
+            numbuf[--numlen] = '0' + digits % 10;
+            digits /= 10;
+        } while (digits != 0);
+
+        if (integer < 0)
+            numbuf[--numlen] = '-';
+
+        jml_json_write(writer, numbuf + numlen, sizeof(numbuf) - numlen);
+        return;
+    }
+
+    /*shortest precision that round-trips*/
+    for (int precision = 15; precision <= 17; ++precision) {
+        numlen = snprintf(numbuf, sizeof(numbuf), "%.*g", precision, num);
+
+        if (precision == 17 || strtod(numbuf, NULL) == num)
+            break;
+    }
+
+    jml_json_write(writer, numbuf, numlen);
+}
+
+
+static bool
+jml_json_value_unparse(jml_json_writer_t *writer, jml_value_t value)
+{
+    if (IS_OBJ(value)) {
+        switch (OBJ_TYPE(value)) {
+            case OBJ_STRING: {
+                jml_obj_string_t *string = AS_STRING(value);
+                jml_json_write_string(writer, string->chars, string->length);
+                break;
+            }
+
+            case OBJ_ARRAY: {
+                jml_obj_array_t *array = AS_ARRAY(value);
+
+                if (writer->depth == JSON_DEPTH_MAX)
+                    return false;
+
+                if (array->values.count == 0) {
+                    jml_json_write(writer, "[]", 2);
+                    break;
+                }
+
+                jml_json_write_char(writer, '[');
+                ++writer->depth;
+
+                for (int i = 0; i < array->values.count; ++i) {
+                    if (i > 0)
+                        jml_json_write_char(writer, ',');
+
+                    jml_json_write_newline(writer, i == 0);
+
+                    if (!jml_json_value_unparse(writer,
+                        array->values.values[i]))
+                        return false;
+                }
+
+                --writer->depth;
+                jml_json_write_newline(writer, true);
+                jml_json_write_char(writer, ']');
+                break;
+            }
+
+            case OBJ_MAP: {
+                jml_hashmap_t *hashmap = &AS_MAP(value)->hashmap;
+                bool first = true;
+
+                if (writer->depth == JSON_DEPTH_MAX)
+                    return false;
+
+                jml_json_write_char(writer, '{');
+                ++writer->depth;
+
+                for (int i = 0; i < hashmap->capacity; ++i) {
+                    jml_hashmap_entry_t *entry = &hashmap->entries[i];
+
+                    if (entry->key == NULL)
+                        continue;
+
+                    if (!first)
+                        jml_json_write_char(writer, ',');
+
+                    jml_json_write_newline(writer, first);
+                    first = false;
+
+                    jml_json_write_string(writer,
+                        entry->key->chars, entry->key->length);
+
+                    if (writer->compact && writer->indent == 0)
+                        jml_json_write_char(writer, ':');
+                    else
+                        jml_json_write(writer, ": ", 2);
+
+                    if (!jml_json_value_unparse(writer, entry->value))
+                        return false;
+                }
+
+                --writer->depth;
+
+                if (!first)
+                    jml_json_write_newline(writer, true);
+
+                jml_json_write_char(writer, '}');
+                break;
+            }
+
+            default:
+                return false;
+        }
+    } else if (IS_NONE(value))
+        jml_json_write(writer, "null", 4);
+
+    else if (IS_BOOL(value)) {
+        if (AS_BOOL(value))
+            jml_json_write(writer, "true", 4);
+        else
+            jml_json_write(writer, "false", 5);
+
+    } else if (IS_NUM(value))
+        jml_json_write_number(writer, AS_NUM(value));
+
+    return true;
+}
+
+
+/*a NULL buffer makes the writer own its data*/
+static jml_obj_exception_t *
+jml_json_unparse_args(int arg_count, jml_value_t *args,
+    jml_json_writer_t *writer, jml_obj_buffer_t *buffer)
+{
+    writer->data = NULL;
+    writer->size = 0;
+    writer->capacity = 0;
+    writer->indent = 0;
+    writer->depth = 0;
+    writer->buffer = buffer;
+    writer->compact = false;
+    writer->failed = false;
+
+    if (arg_count > 1 && !IS_NONE(args[1])) {
+        if (!IS_NUM(args[1]) || AS_NUM(args[1]) < 0)
+            return jml_error_value("indent");
+
+        writer->indent = (size_t)AS_NUM(args[1]);
+    }
+
+    if (arg_count > 2) {
+        if (!IS_BOOL(args[2]))
+            return jml_error_value("compact");
+
+        writer->compact = AS_BOOL(args[2]);
+    }
+
+    if (buffer != NULL) {
+        writer->data = (char*)jml_obj_buffer_data(buffer);
+        writer->size = buffer->length;
+        writer->capacity = buffer->capacity;
+    }
+
+    size_t length = writer->size;
+
+    if (!jml_json_value_unparse(writer, args[0])) {
+        if (buffer != NULL)
+            buffer->length = length;
+        else
+            jml_free(writer->data);
+
+        return jml_obj_exception_new(
+            "JsonErr", "Invalid value to unparse."
+        );
+    }
+
+    if (writer->failed) {
+        buffer->length = length;
+
+        return jml_obj_exception_new(
+            "RangeErr", "Write out of buffer view bounds."
+        );
+    }
+
+    if (buffer != NULL)
+        buffer->length = writer->size;
+
+    return NULL;
+}
+
+
+static jml_obj_exception_t *
+jml_json_error_exception(jml_json_error_t error)
+{
+    const char *errors[] = {
+        "Expected closing bracket or comma",
+        "Expected colon",
+        "Expected quote",
+        "Invalid string escape sequence",
+        "Invalid number",
+        "Invalid value",
+        "Invalid string",
+        "Unexpected eof",
+        "Unexpected trailing characters",
+        "Unknown error"
+    };
+
+    return jml_obj_exception_format(
+        "JsonErr", "%s on line %u column %u (char %u).",
+        errors[error.error - 1],
+        error.line_no, error.col_no, error.off
+    );
+}
+
+
+static jml_value_t
+jml_std_json_parse(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length) || !IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "string or buffer", "number");
+        goto err;
+    }
+
+    double mode = AS_NUM(args[1]);
+    if (mode != MODE_STRICT && mode != MODE_LENIENT && mode != MODE_JSON5) {
+        exc = jml_error_value("parsing mode");
+        goto err;
+    }
+
+    jml_value_t value;
+
+    jml_json_error_t error = jml_json_parse(
+        (const char*)bytes, length, (jml_json_mode)mode, &value
+    );
+
+    if (error.error != ERROR_NONE) {
+        exc = jml_json_error_exception(error);
+        goto err;
+    }
+
+    return value;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_unparse(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+
+    if (arg_count < 1 || arg_count > 3) {
+        exc = jml_error_args(arg_count, 1);
+        goto err;
+    }
+
+    jml_json_writer_t writer;
+    exc = jml_json_unparse_args(arg_count, args, &writer, NULL);
+
+    if (exc != NULL)
+        goto err;
+
+    size_t size = writer.size;
+    char *chars = jml_realloc(writer.data, size + 1);
+    chars[size] = '\0';
+
+    return OBJ_VAL(jml_obj_string_take(chars, size));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_dump(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+
+    if (arg_count < 2 || arg_count > 4) {
+        exc = jml_error_args(arg_count, 2);
+        goto err;
+    }
+
+    if (!IS_BUFFER(args[1])) {
+        exc = jml_error_types(false, 2, "value", "buffer");
+        goto err;
+    }
+
+    jml_obj_buffer_t *buffer = AS_BUFFER(args[1]);
+
+    if (buffer->readonly) {
+        exc = jml_obj_exception_new(
+            "DiffTypes", "Can't write to read-only buffer."
+        );
+        goto err;
+    }
+
+    /*the indent and compact flag are shifted into place*/
+    jml_value_t values[3] = {
+        args[0],
+        arg_count > 2 ? args[2] : NONE_VAL,
+        arg_count > 3 ? args[3] : NONE_VAL
+    };
+
+    size_t length = buffer->length;
+
+    jml_json_writer_t writer;
+    exc = jml_json_unparse_args(arg_count - 1, values, &writer, buffer);
+
+    if (exc != NULL)
+        goto err;
+
+    return NUM_VAL(writer.size - length);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_decoder_init(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = NULL;
+
+    if (arg_count - 1 < 1 || arg_count - 1 > 2) {
+        exc = jml_error_args(arg_count - 1, 1);
+        goto err;
+    }
+
+    if (!IS_NUM(args[0])
+        || (arg_count - 1 == 2 && !IS_BOOL(args[1]))) {
+        exc = jml_error_types(false, 2, "number", "bool");
+        goto err;
+    }
+
+    double mode = AS_NUM(args[0]);
+    if (mode != MODE_STRICT && mode != MODE_LENIENT && mode != MODE_JSON5) {
+        exc = jml_error_value("parsing mode");
+        goto err;
+    }
+
+    jml_obj_instance_t *self    = AS_INSTANCE(args[arg_count - 1]);
+    bool                lines   = arg_count - 1 == 2 && AS_BOOL(args[1]);
+
+    self->extra = jml_json_stream_init((jml_json_mode)mode, lines);
+    return NONE_VAL;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*values decoded before an error are returned, the error is held back*/
+static jml_obj_exception_t *
+jml_std_json_decoder_error(jml_json_stream_t *stream,
+    jml_obj_array_t *array, jml_json_error_t error)
+{
+    if (array->values.count > 0) {
+        stream->pending = error;
+        return NULL;
+    }
+
+    return jml_json_error_exception(error);
+}
+
+
+static jml_value_t
+jml_std_json_decoder_values(jml_json_stream_t *stream, bool last)
+{
+    jml_obj_exception_t *exc = NULL;
+
+    /*an error held back by the previous call is raised first*/
+    if (stream->pending.error != ERROR_NONE) {
+        jml_json_error_t error = stream->pending;
+        stream->pending.error = ERROR_NONE;
+        return OBJ_VAL(jml_json_error_exception(error));
+    }
+
+    jml_obj_array_t *array = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(array));
+
+    size_t end;
+    while (jml_json_stream_scan(stream, &end)) {
+        jml_value_t value = NONE_VAL;
+        jml_json_error_t error = jml_json_stream_parse(stream, end, &value);
+
+        if (error.error != ERROR_NONE) {
+            exc = jml_std_json_decoder_error(stream, array, error);
+            if (exc == NULL)
+                return jml_gc_exempt_pop();
+
+            goto err;
+        }
+
+        jml_gc_exempt_push(value);
+        jml_obj_array_append(array, value);
+        jml_gc_exempt_pop();
+    }
+
+    /*flush the trailing value*/
+    if (last && (stream->scan < stream->size || stream->depth > 0
+        || stream->quote != '\0' || stream->scalar || stream->lines)
+        && !jml_json_stream_blank(stream->buffer + stream->start,
+        stream->size - stream->start)) {
+
+        jml_value_t value = NONE_VAL;
+        jml_json_error_t error = jml_json_stream_parse(
+            stream, stream->size, &value
+        );
+
+        stream->scan = stream->size;
+        stream->depth = 0;
+        stream->quote = '\0';
+        stream->escape = false;
+        stream->scalar = false;
+
+        if (error.error != ERROR_NONE) {
+            exc = jml_std_json_decoder_error(stream, array, error);
+            if (exc == NULL)
+                return jml_gc_exempt_pop();
+
+            goto err;
+        }
+
+        jml_gc_exempt_push(value);
+        jml_obj_array_append(array, value);
+        jml_gc_exempt_pop();
+    }
+
+    return jml_gc_exempt_pop();
+
+err:
+    jml_gc_exempt_pop();
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_decoder_feed(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
+        exc = jml_error_types(false, 1, "string or buffer");
+        goto err;
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[1]);
+
+    if (self->extra == NULL) {
+        exc = jml_error_value("Decoder instance");
+        goto err;
+    }
+
+    jml_json_stream_append(self->extra, (const char*)bytes, length);
+    return jml_std_json_decoder_values(self->extra, false);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_decoder_finish(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 0);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[0]);
+
+    if (self->extra == NULL) {
+        exc = jml_error_value("Decoder instance");
+        goto err;
+    }
+
+    return jml_std_json_decoder_values(self->extra, true);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_json_decoder_free(int arg_count, jml_value_t *args)
+{
+    jml_obj_instance_t *self = AS_INSTANCE(args[arg_count - 1]);
+
+    if (self->extra != NULL) {
+        jml_json_stream_free(self->extra);
+        self->extra = NULL;
+    }
+
+    return NONE_VAL;
+}
+
+
+/*class table*/
+MODULE_TABLE_HEAD decoder_table[] = {
+    {"__init",                      &jml_std_json_decoder_init},
+    {"feed",                        &jml_std_json_decoder_feed},
+    {"finish",                      &jml_std_json_decoder_finish},
+    {"__free",                      &jml_std_json_decoder_free},
+    {NULL,                          NULL}
+};
+
+
+/*module table*/
+MODULE_TABLE_HEAD module_table[] = {
+    {"parse",                       &jml_std_json_parse},
+    {"unparse",                     &jml_std_json_unparse},
+    {"dump",                        &jml_std_json_dump},
+    {NULL,                          NULL}
+};
+
+
+MODULE_FUNC_HEAD
+module_init(jml_obj_module_t *module)
+{
+    jml_module_add_value(module, "MODE_STRICT",  NUM_VAL(MODE_STRICT));
     jml_module_add_value(module, "MODE_LENIENT", NUM_VAL(MODE_LENIENT));
     jml_module_add_value(module, "MODE_JSON5",   NUM_VAL(MODE_JSON5));
+
+    jml_module_add_class(module, "Decoder", decoder_table, false);
 }
@@ -9,6 +9,8 @@
 #endif
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <jml.h>
 
@@ -16,18 +18,269 @@
 #define MATH_NAME(func)             jml_std_math_ ## func
 
 
-#define MATH_CHECK(arg_count, args, arg_num, ...)       \
+/*vectors*/
+#if defined __GNUC__ && defined __AVX__
+
+#include <immintrin.h>
+
+#define LANE_WIDTH                  4
+
+typedef __m256d                     jml_math_lane_t;
+
+#define LANE_LOAD(src)              _mm256_loadu_pd((const double*)(src))
+#define LANE_STORE(dest, lane)      _mm256_storeu_pd((double*)(dest), lane)
+#define LANE_SET(x)                 _mm256_set1_pd(x)
+#define LANE_ADD(a, b)              _mm256_add_pd(a, b)
+#define LANE_SUB(a, b)              _mm256_sub_pd(a, b)
+#define LANE_MUL(a, b)              _mm256_mul_pd(a, b)
+#define LANE_MIN(a, b)              _mm256_min_pd(a, b)
+#define LANE_MAX(a, b)              _mm256_max_pd(a, b)
+#define LANE_OR(a, b)               _mm256_or_pd(a, b)
+#define LANE_NAN(lane)              _mm256_cmp_pd(lane, lane, _CMP_UNORD_Q)
+#define LANE_ANY(mask)              _mm256_movemask_pd(mask)
+
+#elif defined __GNUC__ && defined __SSE2__
+
+#include <emmintrin.h>
+
+#define LANE_WIDTH                  2
+
+typedef __m128d                     jml_math_lane_t;
+
+#define LANE_LOAD(src)              _mm_loadu_pd((const double*)(src))
+#define LANE_STORE(dest, lane)      _mm_storeu_pd((double*)(dest), lane)
+#define LANE_SET(x)                 _mm_set1_pd(x)
+#define LANE_ADD(a, b)              _mm_add_pd(a, b)
+#define LANE_SUB(a, b)              _mm_sub_pd(a, b)
+#define LANE_MUL(a, b)              _mm_mul_pd(a, b)
+#define LANE_MIN(a, b)              _mm_min_pd(a, b)
+#define LANE_MAX(a, b)              _mm_max_pd(a, b)
+#define LANE_OR(a, b)               _mm_or_pd(a, b)
+#define LANE_NAN(lane)              _mm_cmpunord_pd(lane, lane)
+#define LANE_ANY(mask)              _mm_movemask_pd(mask)
+
+#endif
+
+
+/*
+ * numbers of an array or a buffer as packed doubles,
+ * f64 buffers are read in place
+ */
+typedef struct {
+    const uint8_t                  *data;
+    size_t                          count;
+    double                         *owned;
+} jml_math_vector_t;
+
+
+static inline bool
+jml_math_is_vector(jml_value_t value)
+{
+    return IS_ARRAY(value) || IS_BUFFER(value);
+}
+
+
+static inline double
+jml_math_at(const jml_math_vector_t *vector, size_t index)
+{
+    double element;
+    memcpy(&element, vector->data + index * sizeof(double), sizeof(double));
+    return element;
+}
+
+
+static jml_obj_exception_t *
+jml_math_vector_init(jml_math_vector_t *vector, jml_value_t value)
+{
+    vector->data                    = NULL;
+    vector->count                   = 0;
+    vector->owned                   = NULL;
+
+    if (IS_BUFFER(value)) {
+        jml_obj_buffer_t *buffer    = AS_BUFFER(value);
+        vector->count               = jml_obj_buffer_count(buffer);
+
+        if (buffer->type == BUFFER_F64) {
+            vector->data            = jml_obj_buffer_data(buffer);
+            return NULL;
+        }
+
+        if (vector->count > 0)
+            vector->owned           = jml_alloc(vector->count * sizeof(double));
+
+        for (size_t i = 0; i < vector->count; ++i)
+            vector->owned[i]        = jml_obj_buffer_load(buffer, i);
+
+    } else if (IS_ARRAY(value)) {
+        jml_value_array_t *array    = &AS_ARRAY(value)->values;
+
+        for (int i = 0; i < array->count; ++i) {
+            if (!IS_NUM(array->values[i]))
+                return jml_obj_exception_new(
+                    "DiffTypes", "Expected array of numbers."
+                );
+        }
+
+        vector->count               = array->count;
+        if (vector->count > 0)
+            vector->owned           = jml_alloc(vector->count * sizeof(double));
+
+        for (size_t i = 0; i < vector->count; ++i)
+            vector->owned[i]        = AS_NUM(array->values[i]);
+
+    } else
+        return jml_error_types(true, 2, "array", "buffer");
+
+    vector->data                    = (const uint8_t*)vector->owned;
+    return NULL;
+}
+
+
+static void
+jml_math_vector_free(jml_math_vector_t *vector)
+{
+    if (vector->owned != NULL)
+        jml_free(vector->owned);
+}
+
+
+/*zeroed when values is NULL*/
+static jml_obj_buffer_t *
+jml_math_buffer(jml_buffer_type type, const double *values, size_t count)
+{
+    jml_obj_buffer_t *buffer        = jml_obj_buffer_new(
+        count * jml_obj_buffer_stride(type));
+
+    buffer->type                    = type;
+
+    if (count == 0)
+        return buffer;
+
+    if (values == NULL)
+        memset(buffer->bytes, 0, buffer->length);
+    else if (type == BUFFER_F64)
+        memcpy(buffer->bytes, values, count * sizeof(double));
+    else {
+        for (size_t i = 0; i < count; ++i)
+            jml_obj_buffer_store(buffer, i, values[i]);
+    }
+
+    return buffer;
+}
+
+
+/*arrays give arrays, buffers give buffers of type*/
+static jml_value_t
+jml_math_vector_result(jml_value_t shape, jml_buffer_type type,
+    const double *values, size_t count)
+{
+    if (IS_ARRAY(shape)) {
+        jml_obj_array_t *array      = jml_obj_array_new();
+
+        jml_gc_exempt_push(OBJ_VAL(array));
+        jml_value_array_reserve(&array->values, count);
+        jml_gc_exempt_pop();
+
+        for (size_t i = 0; i < count; ++i)
+            array->values.values[i] = NUM_VAL(values[i]);
+
+        array->values.count         = count;
+        return OBJ_VAL(array);
+    }
+
+    return OBJ_VAL(jml_math_buffer(type, values, count));
+}
+
+
+/*applies a scalar function over a vector, buffers come back as f64*/
+#define MATH_MAP1(func, value)                          \
     do {                                                \
-        exc = jml_error_args(                           \
-            arg_count, arg_num);                        \
+        jml_math_vector_t vector;                       \
+        exc = jml_math_vector_init(&vector, value);     \
         if (exc != NULL) goto err;                      \
                                                         \
-        for (int i = 0; i < arg_count; ++i)             \
-            if (!IS_NUM(args[i])) {                     \
-                exc = jml_error_types(                  \
-                false, arg_num, __VA_ARGS__);           \
+        double *out = jml_alloc(                        \
+            (vector.count + 1) * sizeof(double));       \
+                                                        \
+        for (size_t i = 0; i < vector.count; ++i)       \
+            out[i] = func(jml_math_at(&vector, i));     \
+                                                        \
+        jml_value_t result = jml_math_vector_result(    \
+            value, BUFFER_F64, out, vector.count);      \
+                                                        \
+        jml_free(out);                                  \
+        jml_math_vector_free(&vector);                  \
+        return result;                                  \
+    } while (false)
+
+
+/*either operand may be a number, broadcast to the other*/
+#define MATH_MAP2(func, a, b)                           \
+    do {                                                \
+        jml_math_vector_t left, right;                  \
+        double scalar_a = 0, scalar_b = 0;              \
+        jml_value_t shape = jml_math_is_vector(a) ? a : b; \
+                                                        \
+        if (jml_math_is_vector(a)) {                    \
+            exc = jml_math_vector_init(&left, a);       \
+            if (exc != NULL) goto err;                  \
+        } else if (IS_NUM(a)) {                         \
+            scalar_a = AS_NUM(a);                       \
+            left.data = (const uint8_t*)&scalar_a;      \
+            left.count = 1;                             \
+            left.owned = NULL;                          \
+        } else {                                        \
+            exc = jml_error_types(true, 3,              \
+                "number", "array", "buffer");           \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        if (jml_math_is_vector(b)) {                    \
+            exc = jml_math_vector_init(&right, b);      \
+            if (exc != NULL) {                          \
+                jml_math_vector_free(&left);            \
                 goto err;                               \
             }                                           \
+        } else if (IS_NUM(b)) {                         \
+            scalar_b = AS_NUM(b);                       \
+            right.data = (const uint8_t*)&scalar_b;     \
+            right.count = 1;                            \
+            right.owned = NULL;                         \
+        } else {                                        \
+            jml_math_vector_free(&left);                \
+            exc = jml_error_types(true, 3,              \
+                "number", "array", "buffer");           \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        bool wide_a = jml_math_is_vector(a);            \
+        bool wide_b = jml_math_is_vector(b);            \
+        size_t count = wide_a ? left.count : right.count; \
+                                                        \
+        if (wide_a && wide_b && left.count != right.count) { \
+            jml_math_vector_free(&left);                \
+            jml_math_vector_free(&right);               \
+            exc = jml_obj_exception_new(                \
+                "RangeErr", "Operands differ in size."  \
+            );                                          \
+            goto err;                                   \
+        }                                               \
+                                                        \
+        double *out = jml_alloc(                        \
+            (count + 1) * sizeof(double));              \
+                                                        \
+        for (size_t i = 0; i < count; ++i)              \
+            out[i] = func(                              \
+                jml_math_at(&left, wide_a ? i : 0),     \
+                jml_math_at(&right, wide_b ? i : 0));   \
+                                                        \
+        jml_value_t result = jml_math_vector_result(    \
+            shape, BUFFER_F64, out, count);             \
+                                                        \
+        jml_free(out);                                  \
+        jml_math_vector_free(&left);                    \
+        jml_math_vector_free(&right);                   \
+        return result;                                  \
     } while (false)
 
 
@@ -38,13 +291,16 @@
     } while (false)
 
 
+/*arity and types are checked by the vm, see module_signatures*/
 #define MATH_FUNC1(func)                                \
     static jml_value_t                                  \
-    MATH_NAME(func)(int arg_count, jml_value_t *args)   \
+    MATH_NAME(func)(JML_UNUSED(int arg_count),          \
+        jml_value_t *args)                              \
     {                                                   \
         jml_obj_exception_t *exc;                       \
                                                         \
-        MATH_CHECK(arg_count, args, 1, "number");       \
+        if (jml_math_is_vector(args[0]))                \
+            MATH_MAP1(func, args[0]);                   \
                                                         \
         return NUM_VAL(func(                            \
             AS_NUM(args[0])                             \
@@ -56,12 +312,14 @@
 
 #define MATH_FUNC2(func)                                \
     static jml_value_t                                  \
-    MATH_NAME(func)(int arg_count, jml_value_t *args)   \
+    MATH_NAME(func)(JML_UNUSED(int arg_count),          \
+        jml_value_t *args)                              \
     {                                                   \
         jml_obj_exception_t *exc;                       \
                                                         \
-        MATH_CHECK(arg_count, args, 2,                  \
-            "number", "number");                        \
+        if (jml_math_is_vector(args[0])                 \
+            || jml_math_is_vector(args[1]))             \
+            MATH_MAP2(func, args[0], args[1]);          \
                                                         \
         return NUM_VAL(func(                            \
             AS_NUM(args[0]),                            \
@@ -74,20 +332,14 @@
 
 #define MATH_FUNC3(func)                                \
     static jml_value_t                                  \
-    MATH_NAME(func)(int arg_count, jml_value_t *args)   \
+    MATH_NAME(func)(JML_UNUSED(int arg_count),          \
+        jml_value_t *args)                              \
     {                                                   \
-        jml_obj_exception_t *exc;                       \
-                                                        \
-        MATH_CHECK(arg_count, args, 3,                  \
-            "number", "number", "number");              \
-                                                        \
         return NUM_VAL(func(                            \
             AS_NUM(args[0]),                            \
             AS_NUM(args[1]),                            \
             AS_NUM(args[2])                             \
         ));                                             \
-                                                        \
-        MATH_ERR(exc);                                  \
     }
 
 
@@ -138,13 +390,672 @@ MATH_FUNC1(tgamma)
 MATH_FUNC1(trunc)
 
 
-#undef MATH_CHECK
 #undef MATH_ERR
 #undef MATH_FUNC1
 #undef MATH_FUNC2
 #undef MATH_FUNC3
 
 
+/*kernels*/
+typedef enum {
+    KERNEL_SUM,
+    KERNEL_MIN,
+    KERNEL_MAX
+} jml_math_kernel;
+
+
+/*nan wins in min and max, as it does in a sum*/
+static inline double
+jml_math_fold(jml_math_kernel kernel, double a, double b)
+{
+    switch (kernel) {
+        case KERNEL_MIN:    return b < a || isnan(b) ? b : a;
+        case KERNEL_MAX:    return b > a || isnan(b) ? b : a;
+        default:            return a + b;
+    }
+}
+
+
+static double
+jml_math_reduce(const jml_math_vector_t *vector, jml_math_kernel kernel)
+{
+    const uint8_t *data             = vector->data;
+    size_t count                    = vector->count;
+    size_t i                        = 0;
+    double result                   = kernel == KERNEL_SUM
+        ? 0 : jml_math_at(vector, 0);
+
+#ifdef LANE_WIDTH
+    if (count >= LANE_WIDTH) {
+        jml_math_lane_t lane        = kernel == KERNEL_SUM
+            ? LANE_SET(0) : LANE_LOAD(data);
+
+        /*min and max lanes drop nan, so it is tracked apart*/
+        jml_math_lane_t unordered   = LANE_SET(0);
+
+        for (; i + LANE_WIDTH <= count; i += LANE_WIDTH) {
+            jml_math_lane_t block   = LANE_LOAD(data + i * sizeof(double));
+
+            switch (kernel) {
+                case KERNEL_MIN:    lane = LANE_MIN(lane, block);   break;
+                case KERNEL_MAX:    lane = LANE_MAX(lane, block);   break;
+                default:            lane = LANE_ADD(lane, block);   break;
+            }
+
+            if (kernel != KERNEL_SUM)
+                unordered = LANE_OR(unordered, LANE_NAN(block));
+        }
+
+        double lanes[LANE_WIDTH];
+        LANE_STORE(lanes, lane);
+
+        for (int j = 0; j < LANE_WIDTH; ++j)
+            result = jml_math_fold(kernel, result, lanes[j]);
+
+        if (LANE_ANY(unordered))
+            result = NAN;
+    }
+#endif
+
+    for (; i < count; ++i)
+        result = jml_math_fold(kernel, result, jml_math_at(vector, i));
+
+    return result;
+}
+
+
+/*sum of (x - center)^2, the second pass of the variance*/
+static double
+jml_math_deviation(const jml_math_vector_t *vector, double center)
+{
+    const uint8_t *data             = vector->data;
+    size_t count                    = vector->count;
+    size_t i                        = 0;
+    double result                   = 0;
+
+#ifdef LANE_WIDTH
+    jml_math_lane_t lane            = LANE_SET(0);
+    jml_math_lane_t shift           = LANE_SET(center);
+
+    for (; i + LANE_WIDTH <= count; i += LANE_WIDTH) {
+        jml_math_lane_t block       = LANE_SUB(
+            LANE_LOAD(data + i * sizeof(double)), shift);
+
+        lane = LANE_ADD(lane, LANE_MUL(block, block));
+    }
+
+    double lanes[LANE_WIDTH];
+    LANE_STORE(lanes, lane);
+
+    for (int j = 0; j < LANE_WIDTH; ++j)
+        result += lanes[j];
+#endif
+
+    for (; i < count; ++i) {
+        double delta                = jml_math_at(vector, i) - center;
+        result += delta * delta;
+    }
+
+    return result;
+}
+
+
+static double
+jml_math_dot(const jml_math_vector_t *a, const jml_math_vector_t *b)
+{
+    const uint8_t *left             = a->data;
+    const uint8_t *right            = b->data;
+    size_t count                    = a->count;
+    size_t i                        = 0;
+    double result                   = 0;
+
+#ifdef LANE_WIDTH
+    jml_math_lane_t lane            = LANE_SET(0);
+
+    for (; i + LANE_WIDTH <= count; i += LANE_WIDTH)
+        lane = LANE_ADD(lane, LANE_MUL(
+            LANE_LOAD(left + i * sizeof(double)),
+            LANE_LOAD(right + i * sizeof(double))
+        ));
+
+    double lanes[LANE_WIDTH];
+    LANE_STORE(lanes, lane);
+
+    for (int j = 0; j < LANE_WIDTH; ++j)
+        result += lanes[j];
+#endif
+
+    for (; i < count; ++i)
+        result += jml_math_at(a, i) * jml_math_at(b, i);
+
+    return result;
+}
+
+
+/*out = a * scale + b, where b may be missing*/
+static void
+jml_math_axpy(double *out, const jml_math_vector_t *a,
+    double scale, const jml_math_vector_t *b)
+{
+    const uint8_t *left             = a->data;
+    const uint8_t *right            = b != NULL ? b->data : NULL;
+    size_t count                    = a->count;
+    size_t i                        = 0;
+
+#ifdef LANE_WIDTH
+    jml_math_lane_t factor          = LANE_SET(scale);
+
+    for (; i + LANE_WIDTH <= count; i += LANE_WIDTH) {
+        jml_math_lane_t lane        = LANE_MUL(
+            LANE_LOAD(left + i * sizeof(double)), factor);
+
+        if (right != NULL)
+            lane = LANE_ADD(lane, LANE_LOAD(right + i * sizeof(double)));
+
+        LANE_STORE(out + i, lane);
+    }
+#endif
+
+    for (; i < count; ++i)
+        out[i] = jml_math_at(a, i) * scale
+            + (b != NULL ? jml_math_at(b, i) : 0);
+}
+
+
+/*buffers keep their own type, arrays stay arrays*/
+static inline jml_buffer_type
+jml_math_vector_type(jml_value_t value)
+{
+    return IS_BUFFER(value) ? AS_BUFFER(value)->type : BUFFER_F64;
+}
+
+
+/*typed arrays*/
+static jml_value_t
+jml_math_typed(jml_buffer_type type, int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_value_t source              = args[0];
+
+    if (IS_NUM(source)) {
+        size_t stride               = jml_obj_buffer_stride(type);
+        size_t length;
+
+        if (!jml_obj_buffer_size(AS_NUM(source) * stride, &length)) {
+            exc = jml_error_value("typed array size");
+            goto err;
+        }
+
+        return OBJ_VAL(jml_math_buffer(type, NULL, length / stride));
+    }
+
+    if (!jml_math_is_vector(source)) {
+        exc = jml_error_types(true, 3, "number", "array", "buffer");
+        goto err;
+    }
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, source)) != NULL)
+        goto err;
+
+    jml_obj_buffer_t *buffer        = jml_math_buffer(
+        type, NULL, vector.count);
+
+    for (size_t i = 0; i < vector.count; ++i)
+        jml_obj_buffer_store(buffer, i, jml_math_at(&vector, i));
+
+    jml_math_vector_free(&vector);
+    return OBJ_VAL(buffer);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_math_f64(int arg_count, jml_value_t *args)
+{
+    return jml_math_typed(BUFFER_F64, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_math_i32(int arg_count, jml_value_t *args)
+{
+    return jml_math_typed(BUFFER_I32, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_math_u8(int arg_count, jml_value_t *args)
+{
+    return jml_math_typed(BUFFER_U8, arg_count, args);
+}
+
+
+/*statistics*/
+static jml_value_t
+jml_math_reduction(jml_math_kernel kernel, int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, args[0])) != NULL)
+        goto err;
+
+    if (kernel != KERNEL_SUM && vector.count == 0) {
+        jml_math_vector_free(&vector);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Empty array has no extremes."
+        );
+        goto err;
+    }
+
+    double result                   = jml_math_reduce(&vector, kernel);
+
+    jml_math_vector_free(&vector);
+    return NUM_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_math_sum(int arg_count, jml_value_t *args)
+{
+    return jml_math_reduction(KERNEL_SUM, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_math_amin(int arg_count, jml_value_t *args)
+{
+    return jml_math_reduction(KERNEL_MIN, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_math_amax(int arg_count, jml_value_t *args)
+{
+    return jml_math_reduction(KERNEL_MAX, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_math_mean(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, args[0])) != NULL)
+        goto err;
+
+    if (vector.count == 0) {
+        jml_math_vector_free(&vector);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Empty array has no mean."
+        );
+        goto err;
+    }
+
+    double result                   = jml_math_reduce(&vector, KERNEL_SUM)
+        / vector.count;
+
+    jml_math_vector_free(&vector);
+    return NUM_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_math_variance(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = NULL;
+    double ddof                     = 0;
+
+    if (arg_count < 1 || arg_count > 2) {
+        exc = jml_error_args(arg_count, 1);
+        goto err;
+    }
+
+    if (arg_count == 2) {
+        if (!IS_NUM(args[1])) {
+            exc = jml_error_types(false, 2, "array", "number");
+            goto err;
+        }
+
+        ddof = AS_NUM(args[1]);
+    }
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, args[0])) != NULL)
+        goto err;
+
+    if (vector.count <= ddof || ddof < 0) {
+        jml_math_vector_free(&vector);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Too few elements for the variance."
+        );
+        goto err;
+    }
+
+    double mean                     = jml_math_reduce(&vector, KERNEL_SUM)
+        / vector.count;
+
+    double result                   = jml_math_deviation(&vector, mean)
+        / (vector.count - ddof);
+
+    jml_math_vector_free(&vector);
+    return NUM_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*nan sorts last*/
+static int
+jml_math_compare(const void *a, const void *b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    if (isnan(x) || isnan(y))
+        return isnan(x) - isnan(y);
+
+    return (x > y) - (x < y);
+}
+
+
+static jml_value_t
+jml_std_math_percentile(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "array", "number");
+        goto err;
+    }
+
+    double rank                     = AS_NUM(args[1]);
+
+    if (!(rank >= 0 && rank <= 100)) {
+        exc = jml_obj_exception_new(
+            "RangeErr", "Percentile out of range."
+        );
+        goto err;
+    }
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, args[0])) != NULL)
+        goto err;
+
+    size_t count                    = vector.count;
+
+    if (count == 0) {
+        jml_math_vector_free(&vector);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Empty array has no percentiles."
+        );
+        goto err;
+    }
+
+    double *sorted                  = vector.owned;
+    if (sorted == NULL) {
+        sorted                      = jml_alloc(count * sizeof(double));
+        memcpy(sorted, vector.data, count * sizeof(double));
+        vector.owned                = sorted;
+    }
+
+    qsort(sorted, count, sizeof(double), jml_math_compare);
+
+    double position                 = rank / 100 * (count - 1);
+    size_t lower                    = (size_t)position;
+    size_t upper                    = lower + 1 < count ? lower + 1 : lower;
+    double fraction                 = position - lower;
+
+    double result                   = sorted[lower]
+        + (sorted[upper] - sorted[lower]) * fraction;
+
+    jml_math_vector_free(&vector);
+    return NUM_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*counts are built in memory, so the bins are capped*/
+#define HISTOGRAM_MAX               (1 << 20)
+
+
+/*counts per bin, the upper edge falls in the last bin*/
+static jml_value_t
+jml_std_math_histogram(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = NULL;
+
+    if (arg_count != 2 && arg_count != 4) {
+        exc = jml_error_args(arg_count, arg_count < 2 ? 2 : 4);
+        goto err;
+    }
+
+    for (int i = 1; i < arg_count; ++i) {
+        if (!IS_NUM(args[i])) {
+            exc = jml_error_types(false, arg_count,
+                "array", "number", "number", "number");
+            goto err;
+        }
+    }
+
+    double bins                     = AS_NUM(args[1]);
+
+    if (!(bins >= 1 && bins <= HISTOGRAM_MAX) || bins != floor(bins)) {
+        exc = jml_error_value("bin count");
+        goto err;
+    }
+
+    jml_math_vector_t vector;
+    if ((exc = jml_math_vector_init(&vector, args[0])) != NULL)
+        goto err;
+
+    double low                      = 0;
+    double high                     = 0;
+
+    if (arg_count == 4) {
+        low                         = AS_NUM(args[2]);
+        high                        = AS_NUM(args[3]);
+    } else if (vector.count > 0) {
+        low                         = jml_math_reduce(&vector, KERNEL_MIN);
+        high                        = jml_math_reduce(&vector, KERNEL_MAX);
+    }
+
+    if (!(low <= high)) {
+        jml_math_vector_free(&vector);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Histogram range is empty."
+        );
+        goto err;
+    }
+
+    int count                       = (int)bins;
+    double *counts                  = jml_alloc(count * sizeof(double));
+    double width                    = (high - low) / count;
+
+    memset(counts, 0, count * sizeof(double));
+
+    for (size_t i = 0; i < vector.count; ++i) {
+        double value                = jml_math_at(&vector, i);
+
+        if (!(value >= low && value <= high))
+            continue;
+
+        int bin                     = width > 0
+            ? (int)((value - low) / width) : 0;
+
+        counts[bin < count ? bin : count - 1] += 1;
+    }
+
+    jml_math_vector_free(&vector);
+
+    jml_obj_array_t *array          = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(array));
+    jml_value_array_reserve(&array->values, count);
+    jml_gc_exempt_pop();
+
+    for (int i = 0; i < count; ++i)
+        array->values.values[i]     = NUM_VAL(counts[i]);
+
+    array->values.count             = count;
+
+    jml_free(counts);
+    return OBJ_VAL(array);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*elementwise*/
+static jml_value_t
+jml_std_math_dot(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_math_vector_t a, b;
+    if ((exc = jml_math_vector_init(&a, args[0])) != NULL)
+        goto err;
+
+    if ((exc = jml_math_vector_init(&b, args[1])) != NULL) {
+        jml_math_vector_free(&a);
+        goto err;
+    }
+
+    if (a.count != b.count) {
+        jml_math_vector_free(&a);
+        jml_math_vector_free(&b);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Operands differ in size."
+        );
+        goto err;
+    }
+
+    double result                   = jml_math_dot(&a, &b);
+
+    jml_math_vector_free(&a);
+    jml_math_vector_free(&b);
+    return NUM_VAL(result);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*scale and add give buffers of the type of their first operand*/
+static jml_value_t
+jml_std_math_scale(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "array", "number");
+        goto err;
+    }
+
+    jml_math_vector_t a;
+    if ((exc = jml_math_vector_init(&a, args[0])) != NULL)
+        goto err;
+
+    double *out                     = jml_alloc(
+        (a.count + 1) * sizeof(double));
+
+    jml_math_axpy(out, &a, AS_NUM(args[1]), NULL);
+
+    jml_value_t result              = jml_math_vector_result(
+        args[0], jml_math_vector_type(args[0]), out, a.count);
+
+    jml_free(out);
+    jml_math_vector_free(&a);
+    return result;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_math_add(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc        = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_math_vector_t a, b;
+    if ((exc = jml_math_vector_init(&a, args[0])) != NULL)
+        goto err;
+
+    if ((exc = jml_math_vector_init(&b, args[1])) != NULL) {
+        jml_math_vector_free(&a);
+        goto err;
+    }
+
+    if (a.count != b.count) {
+        jml_math_vector_free(&a);
+        jml_math_vector_free(&b);
+        exc = jml_obj_exception_new(
+            "RangeErr", "Operands differ in size."
+        );
+        goto err;
+    }
+
+    double *out                     = jml_alloc(
+        (a.count + 1) * sizeof(double));
+
+    jml_math_axpy(out, &a, 1, &b);
+
+    jml_value_t result              = jml_math_vector_result(
+        args[0], jml_math_vector_type(args[0]), out, a.count);
+
+    jml_free(out);
+    jml_math_vector_free(&a);
+    jml_math_vector_free(&b);
+    return result;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
 /*module table*/
 #define MATH_ENTRY(func)                                \
     {#func,                         &MATH_NAME(func)}
@@ -196,10 +1107,86 @@ MODULE_TABLE_HEAD module_table[] = {
     MATH_ENTRY(tanh),
     MATH_ENTRY(tgamma),
     MATH_ENTRY(trunc),
+    MATH_ENTRY(f64),
+    MATH_ENTRY(i32),
+    MATH_ENTRY(u8),
+    MATH_ENTRY(sum),
+    MATH_ENTRY(amin),
+    MATH_ENTRY(amax),
+    MATH_ENTRY(dot),
+    MATH_ENTRY(mean),
+    MATH_ENTRY(variance),
+    MATH_ENTRY(percentile),
+    MATH_ENTRY(histogram),
+    MATH_ENTRY(scale),
+    MATH_ENTRY(add),
     {NULL,                          NULL}
 };
 
 
+#define MATH_SHAPE                  (JML_PARAM_NUM | JML_PARAM_ARRAY | JML_PARAM_BUFFER)
+
+#define MATH_SIGN1(func)                                \
+    {#func, JML_CFUNC_TYPED, 1, {MATH_SHAPE}}
+
+#define MATH_SIGN2(func)                                \
+    {#func, JML_CFUNC_TYPED, 2, {MATH_SHAPE, MATH_SHAPE}}
+
+#define MATH_SIGN3(func)                                \
+    {#func, JML_CFUNC_TYPED | JML_CFUNC_NOEXC, 3,       \
+        {JML_PARAM_NUM, JML_PARAM_NUM, JML_PARAM_NUM}}
+
+
+MODULE_SIGN_HEAD module_signatures[] = {
+    MATH_SIGN1(acos),
+    MATH_SIGN1(acosh),
+    MATH_SIGN1(asin),
+    MATH_SIGN1(asinh),
+    MATH_SIGN1(atan),
+    MATH_SIGN2(atan2),
+    MATH_SIGN1(atanh),
+    MATH_SIGN1(cbrt),
+    MATH_SIGN1(ceil),
+    MATH_SIGN2(copysign),
+    MATH_SIGN1(cos),
+    MATH_SIGN1(cosh),
+    MATH_SIGN1(erf),
+    MATH_SIGN1(erfc),
+    MATH_SIGN1(exp),
+    MATH_SIGN1(exp2),
+    MATH_SIGN1(expm1),
+    MATH_SIGN1(fabs),
+    MATH_SIGN2(fdim),
+    MATH_SIGN1(floor),
+    MATH_SIGN3(fma),
+    MATH_SIGN2(fmax),
+    MATH_SIGN2(fmin),
+    MATH_SIGN2(fmod),
+    MATH_SIGN2(hypot),
+    MATH_SIGN1(lgamma),
+    MATH_SIGN1(log),
+    MATH_SIGN1(log10),
+    MATH_SIGN1(log1p),
+    MATH_SIGN1(log2),
+    MATH_SIGN1(logb),
+    MATH_SIGN1(nearbyint),
+    MATH_SIGN2(nextafter),
+    MATH_SIGN2(nexttoward),
+    MATH_SIGN2(pow),
+    MATH_SIGN2(remainder),
+    MATH_SIGN1(rint),
+    MATH_SIGN1(round),
+    MATH_SIGN1(sin),
+    MATH_SIGN1(sinh),
+    MATH_SIGN1(sqrt),
+    MATH_SIGN1(tan),
+    MATH_SIGN1(tanh),
+    MATH_SIGN1(tgamma),
+    MATH_SIGN1(trunc),
+    {NULL,                          0, 0, {0}}
+};
+
+
 MODULE_FUNC_HEAD
 module_init(jml_obj_module_t *module)
 {
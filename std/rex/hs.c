@@ -101,13 +101,16 @@ jml_std_rex_hs_database_scan(int arg_count, jml_value_t *args)
     if (exc != NULL)
         goto err;
 
-    if (!IS_STRING(args[0])) {
-        exc = jml_error_types(false, 1, "string");
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
+        exc = jml_error_types(false, 1, "string or buffer");
         goto err;
     }
 
     jml_obj_instance_t *self    = AS_INSTANCE(args[1]);
-    jml_obj_string_t   *subject = AS_STRING(args[0]);
+    const char         *subject = (const char*)bytes;
 
     jml_value_t *flags_value;
     jml_hashmap_get(&self->fields, flags_string, &flags_value);
@@ -123,10 +126,10 @@ jml_std_rex_hs_database_scan(int arg_count, jml_value_t *args)
     jml_obj_array_t *array = jml_obj_array_new();
     jml_gc_exempt_push(OBJ_VAL(array));
     context.array = array;
-    context.source = subject->chars;
+    context.source = subject;
 
     hs_error_t error = hs_scan(
-        self->extra, subject->chars, subject->length, flags,
+        self->extra, subject, length, flags,
         scratch, jml_hs_callback, &context
     );
 
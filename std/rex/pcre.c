@@ -64,13 +64,16 @@ jml_std_rex_pcre_patter_at(int arg_count, jml_value_t *args)
     if (exc != NULL)
         goto err;
 
-    if (!IS_STRING(args[0]) || !IS_NUM(args[1])) {
-        exc = jml_error_types(false, 2, "string", "number");
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length) || !IS_NUM(args[1])) {
+        exc = jml_error_types(false, 2, "string or buffer", "number");
         goto err;
     }
 
     jml_obj_instance_t *self    = AS_INSTANCE(args[2]);
-    jml_obj_string_t   *subject = AS_STRING(args[0]);
+    const char         *subject = (const char*)bytes;
     unsigned int        offset  = AS_NUM(args[1]);
 
     jml_value_t *flags_value;
@@ -82,7 +85,7 @@ jml_std_rex_pcre_patter_at(int arg_count, jml_value_t *args)
     }
 
     int match = pcre_exec(
-        self->extra, NULL, subject->chars, (int)subject->length,
+        self->extra, NULL, subject, (int)length,
         offset, AS_NUM(*flags_value), ovector, ovecsize
     );
 
@@ -100,7 +103,7 @@ jml_std_rex_pcre_patter_at(int arg_count, jml_value_t *args)
         match = ovecsize / 3;
 
     if (match == 1) {
-        char *sub_start = subject->chars + ovector[0];
+        const char *sub_start = subject + ovector[0];
         int sub_length = ovector[1] - ovector[0];
 
         char *buffer = jml_realloc(NULL, sub_length + 1);
@@ -114,7 +117,7 @@ jml_std_rex_pcre_patter_at(int arg_count, jml_value_t *args)
     jml_gc_exempt_push(OBJ_VAL(array));
 
     for (int i = 0; i < match; ++i) {
-        char *sub_start = subject->chars + ovector[2 * i];
+        const char *sub_start = subject + ovector[2 * i];
         int sub_length = ovector[2 * i + 1] - ovector[2 * i];
 
         char *buffer = jml_realloc(NULL, sub_length + 1);
@@ -146,13 +149,16 @@ jml_std_rex_pcre_patter_find(int arg_count, jml_value_t *args)
     if (exc != NULL)
         goto err;
 
-    if (!IS_STRING(args[0])) {
-        exc = jml_error_types(false, 1, "string");
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
+        exc = jml_error_types(false, 1, "string or buffer");
         goto err;
     }
 
     jml_obj_instance_t *self    = AS_INSTANCE(args[1]);
-    jml_obj_string_t   *subject = AS_STRING(args[0]);
+    const char         *subject = (const char*)bytes;
 
     jml_value_t *flags_value;
     jml_hashmap_get(&self->fields, flags_string, &flags_value);
@@ -194,14 +200,14 @@ jml_std_rex_pcre_patter_find(int arg_count, jml_value_t *args)
         int start_offset = ovector[1];
 
         if (ovector[0] == ovector[1]) {
-            if (ovector[0] == (int)subject->length)
+            if (ovector[0] == (int)length)
                 break;
 
             options = PCRE_NOTEMPTY_ATSTART | PCRE_ANCHORED;
         }
 
         match = pcre_exec(
-            self->extra, NULL, subject->chars, (int)subject->length,
+            self->extra, NULL, subject, (int)length,
             start_offset, options, ovector, ovecsize
         );
 
@@ -211,13 +217,13 @@ jml_std_rex_pcre_patter_find(int arg_count, jml_value_t *args)
 
             ovector[1] = start_offset + 1;
 
-            if (crlf_terminator && start_offset < (int)subject->length - 1
-                && subject->chars[start_offset] == '\r'
-                && subject->chars[start_offset + 1] == '\n')
+            if (crlf_terminator && start_offset < (int)length - 1
+                && subject[start_offset] == '\r'
+                && subject[start_offset + 1] == '\n')
                 ++ovector[1];
             else if (utf8) {
-                while (ovector[1] < (int)subject->length) {
-                    if ((subject->chars[ovector[1]] & 0xc0) != 0x80) break;
+                while (ovector[1] < (int)length) {
+                    if ((subject[ovector[1]] & 0xc0) != 0x80) break;
                     ++ovector[1];
                 }
             }
@@ -234,7 +240,7 @@ jml_std_rex_pcre_patter_find(int arg_count, jml_value_t *args)
             match = ovecsize / 3;
 
         for (int i = 0; i < match; ++i) {
-            char *sub_start = subject->chars + ovector[2 * i];
+            const char *sub_start = subject + ovector[2 * i];
             int sub_length = ovector[2 * i + 1] - ovector[2 * i];
 
             char *buffer = jml_realloc(NULL, sub_length + 1);
@@ -229,6 +229,15 @@ jml_std_signal_signal(int arg_count, jml_value_t *args)
     }
 
     if (IS_CFUNCTION(args[1])) {
+        /*handlers are called raw with the signal number*/
+        if ((AS_CFUNCTION(args[1])->flags & JML_CFUNC_TYPED)
+            && (AS_CFUNCTION(args[1])->arity != 1
+            || (AS_CFUNCTION(args[1])->params[0] != JML_PARAM_ANY
+            && !(AS_CFUNCTION(args[1])->params[0] & JML_PARAM_NUM)))) {
+            exc = jml_error_value("handler");
+            goto err;
+        }
+
         jml_cfunction handler = AS_CFUNCTION(args[1])->function;
 
         if (handler == jml_std_signal_sigdfl)
@@ -1,11 +1,14 @@
 #ifdef __GNUC__
 
+#define _GNU_SOURCE
 #define _POSIX_C_SOURCE             200112l
 
 #endif
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
 
 #include <jml.h>
 
@@ -22,9 +25,19 @@
 #include <arpa/inet.h>
 #include <arpa/telnet.h>
 
+#include <sys/uio.h>
+#include <sys/stat.h>
+
 #include <unistd.h>
+#include <fcntl.h>
 #include <netdb.h>
 
+#ifdef __linux__
+
+#include <sys/sendfile.h>
+
+#endif
+
 #else
 
 #error "Current platform not supported."
@@ -32,6 +45,16 @@
 #endif
 
 
+/*recvmmsg takes at most UIO_MAXIOV messages per call*/
+#ifdef UIO_MAXIOV
+#define SOCK_BATCH_MAX              UIO_MAXIOV
+#else
+#define SOCK_BATCH_MAX              1024
+#endif
+
+#define SOCK_BATCH_BYTES            (64 * 1024 * 1024)
+
+
 static jml_obj_class_t *socket_class    = NULL;
 static jml_obj_string_t *domain_string  = NULL;
 static jml_obj_string_t *type_string    = NULL;
@@ -44,6 +67,9 @@ typedef struct {
     bool                            open;
     bool                            bound;
     bool                            connd;
+    bool                            blocking;
+    char                           *buffer;
+    size_t                          buffer_size;
 } jml_std_sock_socket_t;
 
 
@@ -58,11 +84,26 @@ jml_std_sock_socket_internal_init(int fd, int domain, int type)
     internal->open              = true;
     internal->bound             = false;
     internal->connd             = false;
+    internal->blocking          = true;
+    internal->buffer            = NULL;
+    internal->buffer_size       = 0;
 
     return internal;
 }
 
 
+static void
+jml_std_sock_socket_reserve(jml_std_sock_socket_t *internal, size_t size)
+{
+    if (internal->buffer != NULL && internal->buffer_size >= size)
+        return;
+
+    internal->buffer            = jml_realloc(
+        internal->buffer, size > 0 ? size : 1);
+    internal->buffer_size       = size;
+}
+
+
 static jml_value_t
 jml_std_sock_socket_init(int arg_count, jml_value_t *args)
 {
@@ -153,6 +194,7 @@ jml_std_sock_socket_open(int arg_count, jml_value_t *args)
     internal->open              = true;
     internal->bound             = false;
     internal->connd             = false;
+    internal->blocking          = true;
 
     jml_hashmap_set(&self->fields, domain_string, args[0]);
     jml_hashmap_set(&self->fields, type_string, args[1]);
@@ -476,11 +518,16 @@ jml_std_sock_socket_recv(int arg_count, jml_value_t *args)
     }
 
     size_t size = AS_NUM(args[0]);
-    char *buffer = jml_alloc(size + 1);
 
-    ssize_t recvd = recv(internal->fd, buffer, size, 0);
+    jml_std_sock_socket_reserve(internal, size);
+
+    ssize_t recvd = recv(internal->fd, internal->buffer, size, 0);
 
     if (recvd < 0) {
+        if (!internal->blocking
+            && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return NONE_VAL;
+
         exc = jml_obj_exception_format(
             "SocketErr", "%m"
         );
@@ -488,9 +535,68 @@ jml_std_sock_socket_recv(int arg_count, jml_value_t *args)
     }
 
     return OBJ_VAL(
-        jml_obj_string_take(buffer, recvd)
+        jml_obj_string_copy(internal->buffer, recvd)
+    );
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_sock_socket_recv_into(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BUFFER(args[0])) {
+        return OBJ_VAL(jml_error_types(
+            false, 1, "buffer"
+        ));
+    }
+
+    jml_obj_instance_t *self   = AS_INSTANCE(args[1]);
+    jml_obj_buffer_t   *buffer = AS_BUFFER(args[0]);
+    jml_std_sock_socket_t *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("Socket instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->fd == -1) {
+        exc = jml_obj_exception_new(
+            "SocketErr",
+            "Socket instance is closed."
+        );
+        goto err;
+    }
+
+    if (buffer->readonly) {
+        exc = jml_error_value("read-only buffer");
+        goto err;
+    }
+
+    ssize_t recvd = recv(
+        internal->fd, jml_obj_buffer_data(buffer), buffer->length, 0
     );
 
+    if (recvd < 0) {
+        if (!internal->blocking
+            && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return NUM_VAL(0);
+
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    return NUM_VAL(recvd);
+
 err:
     return OBJ_VAL(exc);
 }
@@ -505,14 +611,16 @@ jml_std_sock_socket_send(int arg_count, jml_value_t *args)
     if (exc != NULL)
         goto err;
 
-    if (!IS_STRING(args[0])) {
+    const uint8_t *bytes;
+    size_t         length;
+
+    if (!jml_obj_bytes(args[0], &bytes, &length)) {
         return OBJ_VAL(jml_error_types(
-            false, 1, "string"
+            false, 1, "string or buffer"
         ));
     }
 
     jml_obj_instance_t *self = AS_INSTANCE(args[1]);
-    jml_obj_string_t *string = AS_STRING(args[0]);
     jml_std_sock_socket_t *internal;
 
     if ((internal = self->extra) == NULL) {
@@ -529,10 +637,163 @@ jml_std_sock_socket_send(int arg_count, jml_value_t *args)
     }
 
     ssize_t sent = send(
-        internal->fd, string->chars, string->length + 1, 0
+        internal->fd, bytes, length, 0
     );
 
     if (sent < 0) {
+        if (!internal->blocking
+            && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return NUM_VAL(0);
+
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    return NUM_VAL(sent);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_sock_socket_setblocking(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_BOOL(args[0])) {
+        return OBJ_VAL(jml_error_types(
+            false, 1, "bool"
+        ));
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[1]);
+    jml_std_sock_socket_t *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("Socket instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->fd == -1) {
+        exc = jml_obj_exception_new(
+            "SocketErr",
+            "Socket instance is closed."
+        );
+        goto err;
+    }
+
+    int flags = fcntl(internal->fd, F_GETFL, 0);
+
+    if (flags < 0) {
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    if (AS_BOOL(args[0]))
+        flags &= ~O_NONBLOCK;
+    else
+        flags |= O_NONBLOCK;
+
+    if (fcntl(internal->fd, F_SETFL, flags) < 0) {
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    internal->blocking          = AS_BOOL(args[0]);
+
+    return NONE_VAL;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_sock_socket_sendmsg(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_ARRAY(args[0])) {
+        return OBJ_VAL(jml_error_types(
+            false, 1, "array"
+        ));
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[1]);
+    jml_obj_array_t *array   = AS_ARRAY(args[0]);
+    jml_std_sock_socket_t *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("Socket instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->fd == -1) {
+        exc = jml_obj_exception_new(
+            "SocketErr",
+            "Socket instance is closed."
+        );
+        goto err;
+    }
+
+    int count = array->values.count;
+
+    if (count > IOV_MAX) {
+        exc = jml_obj_exception_format(
+            "SocketErr",
+            "Can't send more than %d buffers at once.",
+            IOV_MAX
+        );
+        goto err;
+    }
+
+    struct iovec *iov = jml_realloc(NULL, sizeof(struct iovec) * (count > 0 ? count : 1));
+
+    for (int i = 0; i < count; ++i) {
+        const uint8_t *bytes;
+        size_t         length;
+
+        if (!jml_obj_bytes(array->values.values[i], &bytes, &length)) {
+            jml_free(iov);
+            exc = jml_error_types(
+                false, 1, "array of strings or buffers"
+            );
+            goto err;
+        }
+
+        iov[i].iov_base         = (void*)bytes;
+        iov[i].iov_len          = length;
+    }
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(struct msghdr));
+
+    message.msg_iov             = iov;
+    message.msg_iovlen          = count;
+
+    ssize_t sent = sendmsg(internal->fd, &message, 0);
+    jml_free(iov);
+
+    if (sent < 0) {
+        if (!internal->blocking
+            && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return NUM_VAL(0);
+
         exc = jml_obj_exception_format(
             "SocketErr", "%m"
         );
@@ -546,6 +807,232 @@ err:
 }
 
 
+static jml_value_t
+jml_std_sock_socket_recvmmsg(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_NUM(args[0]) || !IS_NUM(args[1])) {
+        return OBJ_VAL(jml_error_types(
+            false, 2, "number", "number"
+        ));
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[2]);
+    jml_std_sock_socket_t *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("Socket instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->fd == -1) {
+        exc = jml_obj_exception_new(
+            "SocketErr",
+            "Socket instance is closed."
+        );
+        goto err;
+    }
+
+    /*negated so that nan fails too*/
+    if (!(AS_NUM(args[0]) >= 1 && AS_NUM(args[0]) <= SOCK_BATCH_MAX)) {
+        exc = jml_error_value("message count");
+        goto err;
+    }
+
+    if (!(AS_NUM(args[1]) >= 0
+        && AS_NUM(args[1]) * (size_t)AS_NUM(args[0]) <= SOCK_BATCH_BYTES)) {
+        exc = jml_error_value("buffer size");
+        goto err;
+    }
+
+    size_t count = AS_NUM(args[0]);
+    size_t size  = AS_NUM(args[1]);
+
+    jml_std_sock_socket_reserve(internal, count * size);
+
+    jml_obj_array_t *messages = jml_obj_array_new();
+    jml_value_t      value    = OBJ_VAL(messages);
+    jml_gc_exempt_push(value);
+
+#ifdef __linux__
+    struct mmsghdr *headers = jml_alloc(sizeof(struct mmsghdr) * count);
+    struct iovec   *iov     = jml_realloc(NULL, sizeof(struct iovec) * count);
+
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base         = internal->buffer + i * size;
+        iov[i].iov_len          = size;
+
+        headers[i].msg_hdr.msg_iov      = &iov[i];
+        headers[i].msg_hdr.msg_iovlen   = 1;
+    }
+
+    int recvd = recvmmsg(
+        internal->fd, headers, count, MSG_WAITFORONE, NULL
+    );
+
+    if (recvd < 0) {
+        jml_free(headers);
+        jml_free(iov);
+        jml_gc_exempt_pop();
+
+        if (!internal->blocking
+            && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return value;
+
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    for (int i = 0; i < recvd; ++i) {
+        jml_obj_array_append(
+            messages,
+            OBJ_VAL(jml_obj_string_copy(
+                internal->buffer + i * size, headers[i].msg_len
+            ))
+        );
+    }
+
+    jml_free(headers);
+    jml_free(iov);
+#else
+    for (size_t i = 0; i < count; ++i) {
+        ssize_t recvd = recv(
+            internal->fd, internal->buffer + i * size,
+            size, i > 0 ? MSG_DONTWAIT : 0
+        );
+
+        if (recvd < 0) {
+            if (i > 0 || (!internal->blocking
+                && (errno == EAGAIN || errno == EWOULDBLOCK)))
+                break;
+
+            jml_gc_exempt_pop();
+            exc = jml_obj_exception_format(
+                "SocketErr", "%m"
+            );
+            goto err;
+        }
+
+        jml_obj_array_append(
+            messages,
+            OBJ_VAL(jml_obj_string_copy(
+                internal->buffer + i * size, recvd
+            ))
+        );
+    }
+#endif
+
+    jml_gc_exempt_pop();
+    return value;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_sock_socket_sendfile(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc = jml_error_args(
+        arg_count - 1, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (!IS_STRING(args[0])) {
+        return OBJ_VAL(jml_error_types(
+            false, 1, "string"
+        ));
+    }
+
+    jml_obj_instance_t *self = AS_INSTANCE(args[1]);
+    jml_std_sock_socket_t *internal;
+
+    if ((internal = self->extra) == NULL) {
+        exc = jml_error_value("Socket instance");
+        goto err;
+    }
+
+    if (!internal->open || internal->fd == -1) {
+        exc = jml_obj_exception_new(
+            "SocketErr",
+            "Socket instance is closed."
+        );
+        goto err;
+    }
+
+    int file_fd = open(AS_CSTRING(args[0]), O_RDONLY);
+
+    if (file_fd < 0) {
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(file_fd, &file_stat) < 0) {
+        close(file_fd);
+        exc = jml_obj_exception_format(
+            "SocketErr", "%m"
+        );
+        goto err;
+    }
+
+    off_t  offset = 0;
+    size_t total  = file_stat.st_size;
+
+    while ((size_t)offset < total) {
+#ifdef __linux__
+        ssize_t sent = sendfile(
+            internal->fd, file_fd, &offset, total - offset
+        );
+#else
+        jml_std_sock_socket_reserve(internal, 65536);
+
+        ssize_t sent = pread(
+            file_fd, internal->buffer, internal->buffer_size, offset
+        );
+
+        if (sent > 0)
+            sent = send(internal->fd, internal->buffer, sent, 0);
+
+        if (sent > 0)
+            offset += sent;
+#endif
+
+        if (sent < 0) {
+            if (!internal->blocking
+                && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+
+            close(file_fd);
+            exc = jml_obj_exception_format(
+                "SocketErr", "%m"
+            );
+            goto err;
+        }
+
+        if (sent == 0)
+            break;
+    }
+
+    close(file_fd);
+    return NUM_VAL(offset);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
 static jml_value_t
 jml_std_sock_socket_setopt(int arg_count, jml_value_t *args)
 {
@@ -652,8 +1139,13 @@ jml_std_sock_socket_free(int arg_count, jml_value_t *args)
     jml_obj_instance_t *self = AS_INSTANCE(args[arg_count - 1]);
 
     if (self->extra != NULL) {
-        jml_std_sock_socket_close(1, &args[arg_count - 1]);
-        jml_free(self->extra);
+        jml_std_sock_socket_t *internal = self->extra;
+
+        if (internal->open)
+            jml_std_sock_socket_close(1, &args[arg_count - 1]);
+
+        jml_free(internal->buffer);
+        jml_free(internal);
         self->extra = NULL;
     }
 
@@ -670,7 +1162,12 @@ MODULE_TABLE_HEAD socket_table[] = {
     {"accept",                      &jml_std_sock_socket_accept},
     {"connect",                     &jml_std_sock_socket_connect},
     {"recv",                        &jml_std_sock_socket_recv},
+    {"recv_into",                   &jml_std_sock_socket_recv_into},
     {"send",                        &jml_std_sock_socket_send},
+    {"setblocking",                 &jml_std_sock_socket_setblocking},
+    {"sendmsg",                     &jml_std_sock_socket_sendmsg},
+    {"recvmmsg",                    &jml_std_sock_socket_recvmmsg},
+    {"sendfile",                    &jml_std_sock_socket_sendfile},
     {"setopt",                      &jml_std_sock_socket_setopt},
     {"shutdown",                    &jml_std_sock_socket_shutdown},
     {"close",                       &jml_std_sock_socket_close},
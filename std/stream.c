@@ -0,0 +1,919 @@
+#include <jml.h>
+
+#include <jml/jml_vm.h>
+#include <jml/jml_string.h>
+
+
+/*
+ * a pipeline is an array holding its coroutine and then
+ * its stages in pull order, every stage is itself an array
+ * of slots so that the gc traces whatever it references
+ */
+typedef enum {
+    SLOT_KIND,
+    SLOT_FUNCTION,
+    SLOT_COUNT,
+    SLOT_ITERABLE,
+    SLOT_INDEX,
+    SLOT_MAX
+} jml_stream_slot;
+
+
+typedef enum {
+    STAGE_SOURCE,
+    STAGE_RANGE,
+    STAGE_ZIP,
+    STAGE_MAP,
+    STAGE_FILTER,
+    STAGE_TAKE,
+    STAGE_CHUNK,
+    STAGE_FLAT_MAP
+} jml_stream_kind;
+
+
+typedef enum {
+    STEP_VALUE,
+    STEP_DONE,
+    STEP_ERROR
+} jml_stream_step;
+
+
+static jml_obj_class_t *stream_class    = NULL;
+
+
+static inline bool
+jml_stream_is(jml_value_t value)
+{
+    return IS_INSTANCE(value)
+        && AS_INSTANCE(value)->klass == stream_class;
+}
+
+
+static inline void
+jml_stream_append(jml_obj_array_t *array, jml_value_t value)
+{
+    jml_gc_exempt_push(value);
+    jml_obj_array_append(array, value);
+    jml_gc_exempt_pop();
+}
+
+
+static jml_obj_array_t *
+jml_stream_stage_new(jml_stream_kind kind,
+    jml_value_t function, double count)
+{
+    jml_obj_array_t *stage              = jml_obj_array_new();
+
+    jml_gc_exempt_push(OBJ_VAL(stage));
+    jml_value_array_reserve(&stage->values, SLOT_MAX);
+    jml_gc_exempt_pop();
+
+    jml_value_t *slots                  = stage->values.values;
+    slots[SLOT_KIND]                    = NUM_VAL(kind);
+    slots[SLOT_FUNCTION]                = function;
+    slots[SLOT_COUNT]                   = NUM_VAL(count);
+    slots[SLOT_ITERABLE]                = NONE_VAL;
+    slots[SLOT_INDEX]                   = NUM_VAL(0);
+    stage->values.count                 = SLOT_MAX;
+
+    return stage;
+}
+
+
+static jml_obj_array_t *
+jml_stream_pipeline_new(void)
+{
+    jml_gc_exempt_push(OBJ_VAL(jml_obj_coroutine_new(NULL)));
+
+    jml_obj_array_t *pipeline           = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(pipeline));
+    jml_obj_array_append(pipeline, jml_gc_exempt_peek(1));
+
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+    return pipeline;
+}
+
+
+static jml_stream_step
+jml_stream_call(jml_obj_coroutine_t *coroutine, jml_value_t callee,
+    int arg_count, jml_value_t *args, jml_value_t *result)
+{
+    if (IS_CFUNCTION(callee))
+        *result = jml_obj_cfunction_call(AS_CFUNCTION(callee), arg_count, args);
+
+    else if (!jml_vm_callback(coroutine, callee, arg_count, args, result)) {
+        if (!IS_EXCEPTION(*result))
+            *result = OBJ_VAL(jml_obj_exception_new(
+                "CallErr", "Callback raised an error."
+            ));
+        return STEP_ERROR;
+    }
+
+    return IS_EXCEPTION(*result) ? STEP_ERROR : STEP_VALUE;
+}
+
+
+static bool
+jml_stream_method(jml_value_t value, const char *name,
+    jml_value_t **method)
+{
+    return IS_INSTANCE(value)
+        && !jml_stream_is(value)
+        && jml_hashmap_get(&AS_INSTANCE(value)->klass->statics,
+            AS_STRING(jml_string_intern(name)), method);
+}
+
+
+static jml_stream_step
+jml_stream_invoke(jml_obj_coroutine_t *coroutine, jml_value_t receiver,
+    jml_value_t method, jml_value_t *result)
+{
+    if (IS_CFUNCTION(method))
+        return jml_stream_call(coroutine, method, 1, &receiver, result);
+
+    jml_gc_exempt_push(OBJ_VAL(
+        jml_obj_method_new(receiver, AS_CLOSURE(method))
+    ));
+
+    jml_stream_step step                = jml_stream_call(
+        coroutine, jml_gc_exempt_peek(0), 0, NULL, result);
+
+    jml_gc_exempt_pop();
+    return step;
+}
+
+
+/*
+ * a source stage walking any iterable, instances are resolved
+ * once so that pulling them is a single call per element
+ */
+static jml_stream_step
+jml_stream_cursor(jml_obj_coroutine_t *coroutine,
+    jml_value_t iterable, jml_value_t *cursor)
+{
+    jml_value_t         function        = NONE_VAL;
+    jml_value_t        *method;
+    jml_stream_step     step            = STEP_VALUE;
+
+    jml_gc_exempt_push(iterable);
+
+    if (jml_stream_method(iterable, "__iter", &method)) {
+        if ((step = jml_stream_invoke(coroutine,
+            iterable, *method, &iterable)) == STEP_ERROR) {
+
+            *cursor = iterable;
+            goto end;
+        }
+
+        jml_gc_exempt_pop();
+        jml_gc_exempt_push(iterable);
+    }
+
+    if (IS_INSTANCE(iterable) && !jml_stream_is(iterable)) {
+        jml_obj_instance_t *instance    = AS_INSTANCE(iterable);
+
+        if (!jml_stream_method(iterable, "__next", &method)
+            || (!IS_CFUNCTION(*method) && !IS_CLOSURE(*method))) {
+
+            *cursor = OBJ_VAL(jml_obj_exception_format(
+                "DiffTypes",
+                "Can't iterate instance of '%.*s'.",
+                (int32_t)instance->klass->name->length,
+                instance->klass->name->chars
+            ));
+            step = STEP_ERROR;
+            goto end;
+        }
+
+        if (IS_CFUNCTION(*method))
+            function = *method;
+        else {
+            iterable = OBJ_VAL(jml_obj_method_new(
+                iterable, AS_CLOSURE(*method)));
+
+            jml_gc_exempt_pop();
+            jml_gc_exempt_push(iterable);
+        }
+
+    } else if (!IS_INSTANCE(iterable) && !IS_ARRAY(iterable)
+        && !IS_MAP(iterable) && !IS_STRING(iterable)
+        && !IS_BUFFER(iterable)) {
+
+        *cursor = OBJ_VAL(jml_obj_exception_new(
+            "DiffTypes",
+            "Can iterate only arrays, buffers, maps, strings and instances."
+        ));
+        step = STEP_ERROR;
+        goto end;
+    }
+
+    jml_obj_array_t *stage              = jml_stream_stage_new(
+        STAGE_SOURCE, function, 0);
+
+    stage->values.values[SLOT_ITERABLE] = iterable;
+    *cursor                             = OBJ_VAL(stage);
+
+end:
+    jml_gc_exempt_pop();
+    return step;
+}
+
+
+static jml_stream_step jml_stream_pull(jml_obj_array_t *pipeline,
+    int index, jml_value_t *value);
+
+
+static jml_stream_step
+jml_stream_next(jml_obj_coroutine_t *coroutine,
+    jml_obj_array_t *cursor, jml_value_t *value)
+{
+    jml_value_t        *slots           = cursor->values.values;
+    jml_value_t         iterable        = slots[SLOT_ITERABLE];
+    uint32_t            index           = AS_NUM(slots[SLOT_INDEX]);
+    jml_stream_step     step;
+
+    if (IS_INSTANCE(iterable) || IS_METHOD(iterable)) {
+        if (jml_stream_is(iterable)) {
+            jml_obj_array_t *pipeline   = AS_INSTANCE(iterable)->extra;
+
+            return pipeline == NULL ? STEP_DONE : jml_stream_pull(
+                pipeline, pipeline->values.count - 1, value);
+        }
+
+        step = IS_METHOD(iterable)
+            ? jml_stream_call(coroutine, iterable, 0, NULL, value)
+            : jml_stream_call(coroutine, slots[SLOT_FUNCTION], 1, &iterable, value);
+
+        if (step == STEP_VALUE && IS_NONE(*value))
+            return STEP_DONE;
+
+        return step;
+    }
+
+    if (IS_ARRAY(iterable)) {
+        jml_value_array_t *array        = &AS_ARRAY(iterable)->values;
+
+        if (index >= (uint32_t)array->count)
+            return STEP_DONE;
+
+        *value                          = array->values[index++];
+
+    } else if (IS_MAP(iterable)) {
+        jml_hashmap_t *hashmap          = &AS_MAP(iterable)->hashmap;
+
+        while ((int)index < hashmap->capacity
+            && hashmap->entries[index].key == NULL)
+            ++index;
+
+        if ((int)index >= hashmap->capacity)
+            return STEP_DONE;
+
+        *value                          = OBJ_VAL(hashmap->entries[index++].key);
+
+    } else if (IS_BUFFER(iterable)) {
+        jml_obj_buffer_t *buffer        = AS_BUFFER(iterable);
+
+        if (index >= jml_obj_buffer_count(buffer))
+            return STEP_DONE;
+
+        *value                          = NUM_VAL(jml_obj_buffer_load(buffer, index++));
+
+    } else {
+        jml_obj_string_t *string        = AS_STRING(iterable);
+
+        if (index >= string->length)
+            return STEP_DONE;
+
+        uint32_t size                   = jml_string_charbytes(string->chars, index);
+
+        if (size == 0 || index + size > string->length)
+            size                        = 1;
+
+        *value                          = OBJ_VAL(jml_obj_string_copy(
+            string->chars + index, size));
+        index                          += size;
+    }
+
+    slots[SLOT_INDEX]                   = NUM_VAL(index);
+    return STEP_VALUE;
+}
+
+
+/*pulls one value out of the stage at index, on demand*/
+static jml_stream_step
+jml_stream_pull(jml_obj_array_t *pipeline, int index, jml_value_t *value)
+{
+    jml_obj_coroutine_t *coroutine      = AS_COROUTINE(pipeline->values.values[0]);
+    jml_obj_array_t     *stage          = AS_ARRAY(pipeline->values.values[index]);
+    jml_value_t         *slots          = stage->values.values;
+    jml_value_t          item;
+    jml_stream_step      step;
+
+    switch ((jml_stream_kind)AS_NUM(slots[SLOT_KIND])) {
+        case STAGE_SOURCE:
+            return jml_stream_next(coroutine, stage, value);
+
+        case STAGE_RANGE: {
+            double current              = AS_NUM(slots[SLOT_INDEX]);
+            double stop                 = AS_NUM(slots[SLOT_ITERABLE]);
+            double increment            = AS_NUM(slots[SLOT_COUNT]);
+
+            if (increment > 0 ? current >= stop : current <= stop)
+                return STEP_DONE;
+
+            slots[SLOT_INDEX]           = NUM_VAL(current + increment);
+            *value                      = NUM_VAL(current);
+            return STEP_VALUE;
+        }
+
+        case STAGE_ZIP: {
+            jml_value_array_t *cursors  = &AS_ARRAY(slots[SLOT_FUNCTION])->values;
+            jml_obj_array_t   *tuple    = jml_obj_array_new();
+
+            jml_gc_exempt_push(OBJ_VAL(tuple));
+
+            for (int i = 0; i < cursors->count; ++i) {
+                step = jml_stream_next(coroutine,
+                    AS_ARRAY(cursors->values[i]), value);
+
+                if (step != STEP_VALUE) {
+                    jml_gc_exempt_pop();
+                    return step;
+                }
+
+                jml_stream_append(tuple, *value);
+            }
+
+            *value                      = jml_gc_exempt_pop();
+            return STEP_VALUE;
+        }
+
+        case STAGE_MAP:
+            if ((step = jml_stream_pull(pipeline, index - 1, &item)) != STEP_VALUE)
+                return step;
+
+            jml_gc_exempt_push(item);
+            step = jml_stream_call(coroutine, slots[SLOT_FUNCTION], 1, &item, value);
+            jml_gc_exempt_pop();
+
+            return step;
+
+        case STAGE_FILTER:
+            for (;;) {
+                if ((step = jml_stream_pull(pipeline, index - 1, value)) != STEP_VALUE)
+                    return step;
+
+                item = *value;
+
+                jml_gc_exempt_push(item);
+                step = jml_stream_call(coroutine, slots[SLOT_FUNCTION], 1, &item, value);
+                jml_gc_exempt_pop();
+
+                if (step == STEP_ERROR)
+                    return step;
+
+                if (!jml_value_falsey(*value)) {
+                    *value = item;
+                    return STEP_VALUE;
+                }
+            }
+
+        case STAGE_TAKE: {
+            double remaining            = AS_NUM(slots[SLOT_COUNT]);
+
+            if (remaining <= 0)
+                return STEP_DONE;
+
+            slots[SLOT_COUNT]           = NUM_VAL(remaining - 1);
+            return jml_stream_pull(pipeline, index - 1, value);
+        }
+
+        case STAGE_CHUNK: {
+            int size                    = AS_NUM(slots[SLOT_COUNT]);
+
+            /*an exhausted upstream is never pulled again*/
+            if (size == 0)
+                return STEP_DONE;
+
+            jml_obj_array_t *chunk      = jml_obj_array_new();
+            jml_gc_exempt_push(OBJ_VAL(chunk));
+
+            while (chunk->values.count < size) {
+                step = jml_stream_pull(pipeline, index - 1, value);
+
+                if (step == STEP_ERROR) {
+                    jml_gc_exempt_pop();
+                    return step;
+                }
+
+                if (step == STEP_DONE) {
+                    slots[SLOT_COUNT]   = NUM_VAL(0);
+                    break;
+                }
+
+                jml_stream_append(chunk, *value);
+            }
+
+            jml_gc_exempt_pop();
+
+            if (chunk->values.count == 0)
+                return STEP_DONE;
+
+            *value                      = OBJ_VAL(chunk);
+            return STEP_VALUE;
+        }
+
+        case STAGE_FLAT_MAP:
+            for (;;) {
+                if (!IS_NONE(slots[SLOT_ITERABLE])) {
+                    step = jml_stream_next(coroutine,
+                        AS_ARRAY(slots[SLOT_ITERABLE]), value);
+
+                    if (step != STEP_DONE)
+                        return step;
+
+                    slots[SLOT_ITERABLE] = NONE_VAL;
+                }
+
+                if ((step = jml_stream_pull(pipeline, index - 1, value)) != STEP_VALUE)
+                    return step;
+
+                item = *value;
+
+                jml_gc_exempt_push(item);
+                step = jml_stream_call(coroutine, slots[SLOT_FUNCTION], 1, &item, value);
+                jml_gc_exempt_pop();
+
+                if (step == STEP_ERROR
+                    || jml_stream_cursor(coroutine, *value, value) == STEP_ERROR)
+                    return STEP_ERROR;
+
+                slots[SLOT_ITERABLE]    = *value;
+            }
+    }
+
+    return STEP_DONE;
+}
+
+
+/*
+ * a stream built over another stream shares its stages,
+ * so a chain of combinators fuses into a single pipeline
+ */
+static jml_stream_step
+jml_stream_pipeline(jml_value_t source, jml_value_t *result)
+{
+    if (jml_stream_is(source)
+        && AS_INSTANCE(source)->extra == NULL) {
+
+        *result = OBJ_VAL(jml_error_value("Stream instance"));
+        return STEP_ERROR;
+    }
+
+    jml_obj_array_t *pipeline           = jml_stream_pipeline_new();
+    jml_gc_exempt_push(OBJ_VAL(pipeline));
+
+    if (jml_stream_is(source)) {
+        jml_value_array_t *stages       = &((jml_obj_array_t*)AS_INSTANCE(source)->extra)->values;
+
+        for (int i = 1; i < stages->count; ++i)
+            jml_obj_array_append(pipeline, stages->values[i]);
+
+    } else {
+        jml_value_t cursor;
+
+        if (jml_stream_cursor(AS_COROUTINE(pipeline->values.values[0]),
+            source, &cursor) == STEP_ERROR) {
+
+            jml_gc_exempt_pop();
+            *result = cursor;
+            return STEP_ERROR;
+        }
+
+        jml_stream_append(pipeline, cursor);
+    }
+
+    *result                             = jml_gc_exempt_pop();
+    return STEP_VALUE;
+}
+
+
+static jml_value_t
+jml_stream_wrap(jml_obj_array_t *pipeline)
+{
+    jml_gc_exempt_push(OBJ_VAL(pipeline));
+
+    jml_obj_instance_t *stream          = jml_obj_instance_new(stream_class);
+    jml_gc_exempt_push(OBJ_VAL(stream));
+    jml_gc_exempt_push(jml_string_intern("__stages"));
+
+    /*the field keeps the pipeline alive, extra is the fast path*/
+    jml_hashmap_set(&stream->fields,
+        AS_STRING(jml_gc_exempt_peek(0)), OBJ_VAL(pipeline));
+    stream->extra                       = pipeline;
+
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+
+    return OBJ_VAL(stream);
+}
+
+
+static jml_value_t
+jml_stream_combine(jml_stream_kind kind, int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 2);
+
+    if (exc != NULL)
+        goto err;
+
+    if (stream_class == NULL) {
+        exc = jml_error_value("Stream class");
+        goto err;
+    }
+
+    jml_value_t         function        = NONE_VAL;
+    double              count           = 0;
+
+    if (kind == STAGE_TAKE || kind == STAGE_CHUNK) {
+        if (!IS_NUM(args[1])) {
+            exc = jml_error_types(false, 2, "stream", "number");
+            goto err;
+        }
+
+        count                           = AS_NUM(args[1]);
+
+        if (count < (kind == STAGE_CHUNK) || count != (int32_t)count) {
+            exc = jml_error_value(kind == STAGE_CHUNK ? "chunk size" : "take count");
+            goto err;
+        }
+
+    } else {
+        if (!IS_CLOSURE(args[1]) && !IS_CFUNCTION(args[1])
+            && !IS_METHOD(args[1])) {
+
+            exc = jml_error_types(false, 2, "stream", "function");
+            goto err;
+        }
+
+        function                        = args[1];
+    }
+
+    jml_value_t pipeline;
+    if (jml_stream_pipeline(args[0], &pipeline) == STEP_ERROR)
+        return pipeline;
+
+    jml_gc_exempt_push(pipeline);
+    jml_stream_append(AS_ARRAY(pipeline),
+        OBJ_VAL(jml_stream_stage_new(kind, function, count)));
+    jml_gc_exempt_pop();
+
+    return jml_stream_wrap(AS_ARRAY(pipeline));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_of(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    if (stream_class == NULL) {
+        exc = jml_error_value("Stream class");
+        goto err;
+    }
+
+    if (jml_stream_is(args[0]))
+        return args[0];
+
+    jml_value_t pipeline;
+    if (jml_stream_pipeline(args[0], &pipeline) == STEP_ERROR)
+        return pipeline;
+
+    return jml_stream_wrap(AS_ARRAY(pipeline));
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_range(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = NULL;
+
+    if (arg_count < 1 || arg_count > 3) {
+        exc = jml_error_args(arg_count, 1);
+        goto err;
+    }
+
+    for (int i = 0; i < arg_count; ++i) {
+        if (!IS_NUM(args[i])) {
+            exc = jml_error_types(false, arg_count,
+                "number", "number", "number");
+            goto err;
+        }
+    }
+
+    if (stream_class == NULL) {
+        exc = jml_error_value("Stream class");
+        goto err;
+    }
+
+    double start                        = arg_count > 1 ? AS_NUM(args[0]) : 0;
+    double stop                         = AS_NUM(args[arg_count > 1]);
+    double increment                    = arg_count > 2 ? AS_NUM(args[2]) : 1;
+
+    if (increment == 0) {
+        exc = jml_error_value("range step");
+        goto err;
+    }
+
+    jml_obj_array_t *pipeline           = jml_stream_pipeline_new();
+    jml_gc_exempt_push(OBJ_VAL(pipeline));
+
+    jml_obj_array_t *stage              = jml_stream_stage_new(
+        STAGE_RANGE, NONE_VAL, increment);
+
+    stage->values.values[SLOT_ITERABLE] = NUM_VAL(stop);
+    stage->values.values[SLOT_INDEX]    = NUM_VAL(start);
+
+    jml_stream_append(pipeline, OBJ_VAL(stage));
+    jml_gc_exempt_pop();
+
+    return jml_stream_wrap(pipeline);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_zip(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = NULL;
+
+    if (arg_count < 2) {
+        exc = jml_error_args(arg_count, 2);
+        goto err;
+    }
+
+    if (stream_class == NULL) {
+        exc = jml_error_value("Stream class");
+        goto err;
+    }
+
+    jml_obj_array_t *pipeline           = jml_stream_pipeline_new();
+    jml_gc_exempt_push(OBJ_VAL(pipeline));
+
+    jml_obj_array_t *cursors            = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(cursors));
+
+    for (int i = 0; i < arg_count; ++i) {
+        jml_value_t cursor;
+
+        if (jml_stream_cursor(AS_COROUTINE(pipeline->values.values[0]),
+            args[i], &cursor) == STEP_ERROR) {
+
+            jml_gc_exempt_pop();
+            jml_gc_exempt_pop();
+            return cursor;
+        }
+
+        jml_stream_append(cursors, cursor);
+    }
+
+    jml_stream_append(pipeline, OBJ_VAL(
+        jml_stream_stage_new(STAGE_ZIP, OBJ_VAL(cursors), 0)));
+
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+
+    return jml_stream_wrap(pipeline);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_map(int arg_count, jml_value_t *args)
+{
+    return jml_stream_combine(STAGE_MAP, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_stream_filter(int arg_count, jml_value_t *args)
+{
+    return jml_stream_combine(STAGE_FILTER, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_stream_take(int arg_count, jml_value_t *args)
+{
+    return jml_stream_combine(STAGE_TAKE, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_stream_chunk(int arg_count, jml_value_t *args)
+{
+    return jml_stream_combine(STAGE_CHUNK, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_stream_flat_map(int arg_count, jml_value_t *args)
+{
+    return jml_stream_combine(STAGE_FLAT_MAP, arg_count, args);
+}
+
+
+static jml_value_t
+jml_std_stream_collect(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_value_t pipeline;
+    if (jml_stream_pipeline(args[0], &pipeline) == STEP_ERROR)
+        return pipeline;
+
+    jml_gc_exempt_push(pipeline);
+
+    jml_obj_array_t *array              = jml_obj_array_new();
+    jml_gc_exempt_push(OBJ_VAL(array));
+
+    int last                            = AS_ARRAY(pipeline)->values.count - 1;
+    jml_value_t value;
+    jml_stream_step step;
+
+    while ((step = jml_stream_pull(AS_ARRAY(pipeline), last, &value)) == STEP_VALUE)
+        jml_stream_append(array, value);
+
+    jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+
+    return step == STEP_ERROR ? value : OBJ_VAL(array);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_fold(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 3);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_value_t pipeline;
+    if (jml_stream_pipeline(args[0], &pipeline) == STEP_ERROR)
+        return pipeline;
+
+    jml_gc_exempt_push(pipeline);
+    jml_gc_exempt_push(args[2]);
+
+    jml_obj_coroutine_t *coroutine      = AS_COROUTINE(AS_ARRAY(pipeline)->values.values[0]);
+    int last                            = AS_ARRAY(pipeline)->values.count - 1;
+    jml_value_t pair[2];
+    jml_value_t value;
+    jml_stream_step step;
+
+    while ((step = jml_stream_pull(AS_ARRAY(pipeline), last, &value)) == STEP_VALUE) {
+        pair[0]                         = jml_gc_exempt_peek(0);
+        pair[1]                         = value;
+
+        jml_gc_exempt_push(value);
+        step = jml_stream_call(coroutine, args[1], 2, pair, &value);
+        jml_gc_exempt_pop();
+
+        if (step == STEP_ERROR)
+            break;
+
+        /*the accumulator stays rooted between calls*/
+        jml_gc_exempt_pop();
+        jml_gc_exempt_push(value);
+    }
+
+    jml_value_t result                  = jml_gc_exempt_pop();
+    jml_gc_exempt_pop();
+
+    return step == STEP_ERROR ? value : result;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_count(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count, 1);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_value_t pipeline;
+    if (jml_stream_pipeline(args[0], &pipeline) == STEP_ERROR)
+        return pipeline;
+
+    jml_gc_exempt_push(pipeline);
+
+    int last                            = AS_ARRAY(pipeline)->values.count - 1;
+    double count                        = 0;
+    jml_value_t value;
+    jml_stream_step step;
+
+    while ((step = jml_stream_pull(AS_ARRAY(pipeline), last, &value)) == STEP_VALUE)
+        ++count;
+
+    jml_gc_exempt_pop();
+
+    return step == STEP_ERROR ? value : NUM_VAL(count);
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+static jml_value_t
+jml_std_stream_next(int arg_count, jml_value_t *args)
+{
+    jml_obj_exception_t *exc            = jml_error_args(
+        arg_count - 1, 0);
+
+    if (exc != NULL)
+        goto err;
+
+    jml_obj_instance_t *self            = AS_INSTANCE(args[arg_count - 1]);
+    jml_obj_array_t    *pipeline        = self->extra;
+
+    if (pipeline == NULL) {
+        exc = jml_error_value("Stream instance");
+        goto err;
+    }
+
+    jml_value_t value;
+    jml_stream_step step                = jml_stream_pull(
+        pipeline, pipeline->values.count - 1, &value);
+
+    return step == STEP_DONE ? NONE_VAL : value;
+
+err:
+    return OBJ_VAL(exc);
+}
+
+
+/*class table*/
+MODULE_TABLE_HEAD stream_table[] = {
+    {"__next",                      &jml_std_stream_next},
+    {NULL,                          NULL}
+};
+
+
+/*module table*/
+MODULE_TABLE_HEAD module_table[] = {
+    {"of",                          &jml_std_stream_of},
+    {"range",                       &jml_std_stream_range},
+    {"zip",                         &jml_std_stream_zip},
+    {"map",                         &jml_std_stream_map},
+    {"filter",                      &jml_std_stream_filter},
+    {"take",                        &jml_std_stream_take},
+    {"chunk",                       &jml_std_stream_chunk},
+    {"flat_map",                    &jml_std_stream_flat_map},
+    {"collect",                     &jml_std_stream_collect},
+    {"fold",                        &jml_std_stream_fold},
+    {"count",                       &jml_std_stream_count},
+    {NULL,                          NULL}
+};
+
+
+MODULE_FUNC_HEAD
+module_init(jml_obj_module_t *module)
+{
+    jml_module_add_class(module, "Stream", stream_table, false);
+
+    jml_value_t *stream_value;
+    if (jml_hashmap_get(&module->globals,
+        AS_STRING(jml_string_intern("Stream")), &stream_value))
+        stream_class = AS_CLASS(*stream_value);
+}